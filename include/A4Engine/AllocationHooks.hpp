@@ -0,0 +1,132 @@
+#pragma once
+
+#include <A4Engine/AllocationTracker.hpp>
+
+// Replaces the global operator new/delete so allocations go through AllocationTracker, only with the "allocationtracking" option.
+// Replacement operators can't be inline: this header must be included by exactly one source file of each module (each executable,
+// the engine already does it) since on Windows every module keeps its own operators
+#ifdef A4ENGINE_ALLOCATION_TRACKING
+
+#include <cstddef>
+#include <new>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define A4_ALLOCATION_CALL_SITE() _ReturnAddress()
+#else
+#define A4_ALLOCATION_CALL_SITE() __builtin_return_address(0)
+#endif
+
+void* operator new(std::size_t size)
+{
+	if (void* memory = AllocationTracker::Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, A4_ALLOCATION_CALL_SITE()))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	if (void* memory = AllocationTracker::Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, A4_ALLOCATION_CALL_SITE()))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	if (void* memory = AllocationTracker::Allocate(size, static_cast<std::size_t>(alignment), A4_ALLOCATION_CALL_SITE()))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	if (void* memory = AllocationTracker::Allocate(size, static_cast<std::size_t>(alignment), A4_ALLOCATION_CALL_SITE()))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return AllocationTracker::Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, A4_ALLOCATION_CALL_SITE());
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return AllocationTracker::Allocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__, A4_ALLOCATION_CALL_SITE());
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocationTracker::Allocate(size, static_cast<std::size_t>(alignment), A4_ALLOCATION_CALL_SITE());
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return AllocationTracker::Allocate(size, static_cast<std::size_t>(alignment), A4_ALLOCATION_CALL_SITE());
+}
+
+void operator delete(void* memory) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	AllocationTracker::Deallocate(memory);
+}
+
+#endif
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Allocations are only seen with the "allocationtracking" option (xmake f --allocationtracking=y), which makes every module including
+// <A4Engine/AllocationHooks.hpp> route its global operator new/delete here. A4_ALLOCATION_TAG names must be string literals
+// (or live as long as the program), profiler zones tag their allocations too
+#ifdef A4ENGINE_ALLOCATION_TRACKING
+#define A4_ALLOCATION_CONCAT_IMPL(a, b) a##b
+#define A4_ALLOCATION_CONCAT(a, b) A4_ALLOCATION_CONCAT_IMPL(a, b)
+#define A4_ALLOCATION_TAG(name) AllocationTagScope A4_ALLOCATION_CONCAT(allocationTagScope, __LINE__)(name)
+#else
+#define A4_ALLOCATION_TAG(name) do {} while (false)
+#endif
+
+struct AllocationCallSite
+{
+	const void* address; //< return address of operator new (nullptr for the call sites which didn't fit), to look up in the debugger
+	const char* tag; //< active when the call site was first seen
+	std::size_t allocationCount;
+	std::size_t allocatedBytes;
+};
+
+struct AllocationTagStats
+{
+	const char* tag;
+	std::size_t allocationCount;
+	std::size_t allocatedBytes;
+	std::size_t lastFrameAllocationCount;
+	std::size_t lastFrameAllocatedBytes;
+};
+
+enum class ForbiddenAllocationPolicy
+{
+	Abort, //< prints the call site and aborts
+	Count
+};
+
+// Counts the allocations made while it exists: per frame, per tag (innermost scope of the allocating thread) and per call site,
+// with live and peak bytes. Counters are fixed tables updated without locks nor allocations, tags and call sites which don't fit are merged
+class A4ENGINE_API AllocationTracker
+{
+	public:
+		AllocationTracker();
+		AllocationTracker(const AllocationTracker&) = delete;
+		AllocationTracker(AllocationTracker&&) = delete;
+		~AllocationTracker();
+
+		//Once per frame, the last frame counters are the ones between the two last calls
+		void EndFrame();
+
+		std::vector<AllocationCallSite> GetCallSites(std::size_t maxCount) const; //< the most frequent first
+		std::size_t GetLastFrameAllocatedBytes() const;
+		std::size_t GetLastFrameAllocationCount() const;
+		std::size_t GetLiveBytes() const; //< allocated since the tracker exists and not freed yet
+		std::size_t GetPeakBytes() const;
+		std::string GetReport(std::size_t callSiteCount = 10) const;
+		std::vector<AllocationTagStats> GetTagStats() const; //< the most allocated bytes first
+		std::size_t GetTotalAllocationCount() const;
+
+		void ResetPeak();
+
+		AllocationTracker& operator=(const AllocationTracker&) = delete;
+		AllocationTracker& operator=(AllocationTracker&&) = delete;
+
+		//Called by the hooks, Allocate returns nullptr on failure
+		static void* Allocate(std::size_t size, std::size_t alignment, const void* callSite);
+		static void Deallocate(void* memory);
+
+		static AllocationTracker& Instance();
+		static bool IsEnabled(); //< a tracker exists
+
+		//nullptr keeps the current tag
+		static void PopTag();
+		static void PushTag(const char* tag);
+
+	private:
+		std::size_t m_frameStartAllocatedBytes;
+		std::size_t m_frameStartAllocationCount;
+		std::size_t m_lastFrameAllocatedBytes;
+		std::size_t m_lastFrameAllocationCount;
+
+		static AllocationTracker* s_instance;
+};
+
+// Tags the allocations of this thread during its lifetime
+class AllocationTagScope
+{
+	public:
+		inline explicit AllocationTagScope(const char* tag);
+		AllocationTagScope(const AllocationTagScope&) = delete;
+		AllocationTagScope(AllocationTagScope&&) = delete;
+		inline ~AllocationTagScope();
+
+		AllocationTagScope& operator=(const AllocationTagScope&) = delete;
+		AllocationTagScope& operator=(AllocationTagScope&&) = delete;
+};
+
+// Steady state check: allocations of this thread during its lifetime are counted (with or without a tracker) or abort the program.
+// Only works when the hooks are compiled, scopes can be nested
+class A4ENGINE_API NoAllocationScope
+{
+	public:
+		explicit NoAllocationScope(ForbiddenAllocationPolicy policy = ForbiddenAllocationPolicy::Count);
+		NoAllocationScope(const NoAllocationScope&) = delete;
+		NoAllocationScope(NoAllocationScope&&) = delete;
+		~NoAllocationScope();
+
+		std::size_t GetAllocationCount() const; //< made by this thread since the scope began
+
+		NoAllocationScope& operator=(const NoAllocationScope&) = delete;
+		NoAllocationScope& operator=(NoAllocationScope&&) = delete;
+
+	private:
+		ForbiddenAllocationPolicy m_previousPolicy;
+		std::size_t m_startCount;
+};
+
+#include <A4Engine/AllocationTracker.inl>
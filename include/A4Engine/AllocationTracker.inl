@@ -0,0 +1,9 @@
+AllocationTagScope::AllocationTagScope(const char* tag)
+{
+	AllocationTracker::PushTag(tag);
+}
+
+AllocationTagScope::~AllocationTagScope()
+{
+	AllocationTracker::PopTag();
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+
+// Sounds are heard from the Transform of the entity holding this component (usually the camera)
+struct A4ENGINE_API AudioListenerComponent
+{
+};
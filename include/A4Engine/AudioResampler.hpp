@@ -0,0 +1,46 @@
+#pragma once
+#include <A4Engine/Export.hpp>
+#include <cstdint>
+#include <vector>
+
+// Polyphase windowed-sinc resampler, meant to run once at load time so playback never has to resample
+class A4ENGINE_API AudioResampler
+{
+public:
+	AudioResampler(unsigned int inputRate, unsigned int outputRate); //< throws on a zero rate
+	AudioResampler(const AudioResampler&) = default;
+	AudioResampler(AudioResampler&&) = default;
+	~AudioResampler() = default;
+
+	// Carried between the chunks of a stream, so resampling it chunk by chunk gives the same frames as resampling it at once
+	struct StreamState
+	{
+		std::vector<std::vector<float>> channels; //< input frames the next output frames still need
+		std::uint64_t position = 0; //< of the next output frame, in input frames * upFactor from the start of channels
+	};
+
+	std::size_t GetOutputFrameCount(std::size_t inputFrameCount) const;
+
+	//Interleaved samples in, interleaved samples out (same channel count)
+	std::vector<std::int16_t> Process(const std::int16_t* samples, std::size_t frameCount, unsigned int channelCount) const;
+
+	//Appends to output the frames this chunk completes, the last ones need the next chunk (or Flush at the end of the stream)
+	void ProcessChunk(const std::int16_t* samples, std::size_t frameCount, unsigned int channelCount, StreamState& state, std::vector<std::int16_t>& output) const;
+	//Appends the frames left at the end of the stream and resets the state
+	void Flush(unsigned int channelCount, StreamState& state, std::vector<std::int16_t>& output) const;
+
+	AudioResampler& operator=(const AudioResampler&) = default;
+	AudioResampler& operator=(AudioResampler&&) = default;
+
+	//Downmixes to mono or stereo (or duplicates a mono channel), interleaved in and out
+	static std::vector<std::int16_t> ConvertChannels(const std::int16_t* samples, std::size_t frameCount, unsigned int inputChannelCount, unsigned int outputChannelCount);
+
+	static constexpr std::size_t MaxPhaseCount = 1024;
+	static constexpr std::size_t TapCount = 32;
+
+private:
+	std::vector<float> m_coefficients; //< TapCount coefficients per phase
+	std::uint64_t m_upFactor;
+	std::uint64_t m_downFactor;
+	std::size_t m_phaseCount;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <A4Engine/SoundSystem.h>
+#include <memory>
+
+class AudioSystem;
+class Sound;
+
+class A4ENGINE_API AudioSourceComponent
+{
+	friend AudioSystem;
+
+	public:
+		AudioSourceComponent(std::shared_ptr<const Sound> sound, float maxDistance = 1000.f, bool looping = true);
+
+		float GetGain() const;
+		float GetMaxDistance() const;
+		float GetPlaybackOffset() const;
+
+		//True when the source has no voice (out of range or inaudible), it keeps advancing without using any
+		bool IsVirtual() const;
+		bool IsPlaying() const;
+
+		void Play();
+
+		void SetGain(float gain);
+		void SetMaxDistance(float maxDistance);
+		void SetPriority(int priority);
+
+		void Stop();
+
+	private:
+		std::shared_ptr<const Sound> m_sound;
+		VoiceHandle m_voice;
+		float m_gain;
+		float m_maxDistance;
+		float m_playbackOffset;
+		int m_priority;
+		bool m_looping;
+		bool m_playing;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <entt/fwd.hpp>
+
+class A4ENGINE_API AudioSystem
+{
+	public:
+		AudioSystem(entt::registry& registry);
+		AudioSystem(const AudioSystem&) = delete;
+		AudioSystem(AudioSystem&&) = delete;
+		~AudioSystem();
+
+		void Update(float deltaTime);
+
+		AudioSystem& operator=(const AudioSystem&) = delete;
+		AudioSystem& operator=(AudioSystem&&) = delete;
+
+		// Below this gain a source loses its voice, it gets one back above twice this gain (avoids flickering at the limit)
+		static constexpr float AudibleGain = 0.01f;
+
+	private:
+		void OnSourceDestroy(entt::registry& registry, entt::entity entity);
+
+		entt::registry& m_registry;
+};
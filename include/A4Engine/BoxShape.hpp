@@ -9,8 +9,8 @@ public:
 	BoxShape(float width, float height);
 	~BoxShape() = default;
 
-	float GetMoment(float mass) override;
-	cpShape* CreateShape(cpBody* body) override;
+	float GetMoment(float mass) const override;
+	cpShape* CreateShape(cpBody* body, void* memory) const override;
 private:
 	float m_width;
 	float m_height;
@@ -9,8 +9,8 @@ public:
 	CircleShape(float radius);
 	~CircleShape() = default;
 
-	cpShape* CreateShape(cpBody* body) override;
-	float GetMoment(float mass) override;
+	cpShape* CreateShape(cpBody* body, void* memory) const override;
+	float GetMoment(float mass) const override;
 private:
 	float m_radius;
 };
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <A4Engine/Vector2.hpp>
+#include <entt/fwd.hpp>
+
+enum class CollisionEventType
+{
+	Begin,     //< the shapes started touching during the step
+	PostSolve, //< still touching, impulse holds what the solver applied (only with PhysicsSettings::postSolveEvents)
+	Separate   //< the shapes stopped touching
+};
+
+// Written by PhysicsSystem during a step, entities are entt::null for bodies without a RigidBodyComponent (static level geometry)
+struct CollisionEvent
+{
+	CollisionEventType type;
+	entt::entity entityA;
+	entt::entity entityB;
+	Vector2f normal;  //< from A to B
+	Vector2f point;   //< first contact point, (0, 0) for Separate
+	Vector2f impulse; //< total impulse applied to the pair, (0, 0) unless PostSolve
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <A4Engine/PolygonShape.hpp>
+#include <A4Engine/Vector2.hpp>
+#include <nlohmann/json_fwd.hpp>
+#include <SDL.h>
+#include <filesystem>
+#include <vector>
+
+class Model;
+class SDLppSurface;
+
+// Set of convex polygons approximating an asset, built from a model triangles or from a sprite alpha channel
+// Building it isn't free (especially from a sprite), ResourceManager::GetCollisionGeometry caches the result next to the asset
+class A4ENGINE_API CollisionGeometry
+{
+public:
+	CollisionGeometry() = default;
+	CollisionGeometry(std::vector<std::vector<Vector2f>> polygons);
+	CollisionGeometry(const CollisionGeometry&) = default;
+	CollisionGeometry(CollisionGeometry&&) = default;
+	~CollisionGeometry() = default;
+
+	//vertex = polygonVertex * scale + offset
+	std::vector<PolygonShape> CreateShapes(const Vector2f& scale = Vector2f(1.f, 1.f), const Vector2f& offset = Vector2f(0.f, 0.f), float radius = 0.f) const;
+
+	std::size_t GetMemoryUsage() const; //< bytes
+	const std::vector<std::vector<Vector2f>>& GetPolygons() const;
+	std::size_t GetVertexCount() const;
+
+	bool IsValid() const;
+
+	bool SaveToFile(const std::filesystem::path& filepath) const;
+	nlohmann::ordered_json SaveToJSon() const;
+
+	CollisionGeometry& operator=(const CollisionGeometry&) = default;
+	CollisionGeometry& operator=(CollisionGeometry&&) = default;
+
+	//Polygons are in model space, triangles sharing an edge are merged as long as the result stays convex
+	static CollisionGeometry BuildFromModel(const Model& model, std::size_t maxVertexCount = DefaultMaxVertexCount);
+	//Polygons are in pixels, from the top-left corner of the surface; holes in the opaque area are filled
+	//tolerance is the maximum distance (in pixels) between the traced outline and the simplified one
+	static CollisionGeometry BuildFromSurface(const SDLppSurface& surface, Uint8 alphaThreshold = 128, float tolerance = 1.5f, std::size_t maxVertexCount = DefaultMaxVertexCount);
+
+	static CollisionGeometry LoadFromFile(const std::filesystem::path& filepath);
+	static CollisionGeometry LoadFromJSon(const nlohmann::json& doc);
+
+	static constexpr std::size_t DefaultMaxVertexCount = 6; //< up to CP_POLY_SHAPE_INLINE_ALLOC, Chipmunk stores the vertices inside the shape
+
+private:
+	std::vector<std::vector<Vector2f>> m_polygons;
+};
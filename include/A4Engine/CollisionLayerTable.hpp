@@ -0,0 +1,39 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <chipmunk/chipmunk.h>
+#include <array>
+#include <string>
+#include <vector>
+
+// Named collision layers and which of them collide with each other, turned into Chipmunk category/mask filters:
+// each layer is one category bit, its mask holds the layers it collides with.
+// Pairs rejected by the filters are dropped right after the broadphase, before any contact is generated
+class A4ENGINE_API CollisionLayerTable
+{
+public:
+	CollisionLayerTable(); //< starts with the "Default" layer (0)
+
+	//New layers collide with every layer (including themselves) until told otherwise
+	unsigned int AddLayer(std::string name);
+
+	bool DoLayersCollide(unsigned int firstLayer, unsigned int secondLayer) const;
+
+	cpShapeFilter GetFilter(unsigned int layer) const;
+	unsigned int GetLayer(const std::string& name) const;
+	std::size_t GetLayerCount() const;
+	const std::string& GetLayerName(unsigned int layer) const;
+
+	//Returns the layer of a filter built by GetFilter, InvalidLayer for any other filter
+	static unsigned int GetFilterLayer(const cpShapeFilter& filter);
+
+	void SetLayersCollide(unsigned int firstLayer, unsigned int secondLayer, bool collide);
+
+	static constexpr unsigned int DefaultLayer = 0;
+	static constexpr unsigned int InvalidLayer = 0xFFFFFFFF;
+	static constexpr std::size_t MaxLayerCount = 32; //< cpBitmask size
+
+private:
+	std::array<cpBitmask, MaxLayerCount> m_masks;
+	std::vector<std::string> m_names;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <functional>
+#include <vector>
+
+// Owns the fixed timestep accumulator: systems added here run a whole number of times per frame, always with the same step,
+// the time left in the accumulator is exposed as an alpha so rendering can interpolate between the last two fixed states
+class A4ENGINE_API FixedStepScheduler
+{
+	public:
+		using System = std::function<void(float /*timeStep*/)>;
+
+		FixedStepScheduler(float timeStep, unsigned int maxStepCount = 5);
+		FixedStepScheduler(const FixedStepScheduler&) = delete;
+		FixedStepScheduler(FixedStepScheduler&&) = delete;
+		~FixedStepScheduler() = default;
+
+		//Systems run in the order they were added
+		void AddSystem(System system);
+
+		float GetAlpha() const; //< [0, 1[, how far the current frame is between the previous and the current fixed step
+		unsigned int GetMaxStepCount() const;
+		float GetTimeStep() const;
+
+		void SetMaxStepCount(unsigned int maxStepCount);
+		void SetTimeStep(float timeStep);
+
+		//Returns the number of fixed steps that were run
+		unsigned int Update(float deltaTime);
+
+		FixedStepScheduler& operator=(const FixedStepScheduler&) = delete;
+		FixedStepScheduler& operator=(FixedStepScheduler&&) = delete;
+
+	private:
+		std::vector<System> m_systems;
+		float m_accumulator;
+		float m_timeStep;
+		unsigned int m_maxStepCount;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <A4Engine/LinearArena.hpp>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+// Scratch memory living until the end of the frame: each thread allocates from its own LinearArena (no lock, created on its first use
+// and kept until the FrameArena is destroyed, meant for the main thread and the job workers), the main loop resets all of them with EndFrame. Containers using it must not outlive the frame, nor be used by jobs still running at its end:
+//   std::pmr::vector<float> extents(FrameArena::GetResource());
+class A4ENGINE_API FrameArena
+{
+	public:
+		FrameArena(std::size_t blockSize = 256 * 1024);
+		FrameArena(const FrameArena&) = delete;
+		FrameArena(FrameArena&&) = delete;
+		~FrameArena();
+
+		//Once per frame, when no thread uses frame memory anymore
+		void EndFrame();
+
+		//Of every thread, measured by the last EndFrame
+		std::size_t GetCapacity() const;
+		std::size_t GetLastFrameUsage() const;
+		std::size_t GetThreadCount() const;
+
+		FrameArena& operator=(const FrameArena&) = delete;
+		FrameArena& operator=(FrameArena&&) = delete;
+
+		static FrameArena& Instance();
+		static bool IsEnabled();
+
+		//Arena of the calling thread, or the default resource when there's no FrameArena (the memory is then freed as usual)
+		static std::pmr::memory_resource* GetResource();
+
+	private:
+		LinearArena& GetThreadArena();
+
+		std::vector<std::unique_ptr<LinearArena>> m_arenas;
+		mutable std::mutex m_arenaMutex;
+		std::size_t m_blockSize;
+		std::size_t m_capacity;
+		std::size_t m_lastFrameUsage;
+		std::uint64_t m_generation;
+
+		static FrameArena* s_instance;
+};
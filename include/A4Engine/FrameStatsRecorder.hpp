@@ -0,0 +1,72 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class FrameStatsFormat
+{
+	CSV,
+	NDJSON //< one JSON object per line
+};
+
+// Streams one row of values per frame to a file. Rows are copied into a ring allocated by Start and written by a background thread,
+// the game thread never waits for the file: if the writer falls behind by a whole ring, new rows are dropped (and counted)
+class A4ENGINE_API FrameStatsRecorder
+{
+	public:
+		FrameStatsRecorder(std::size_t rowCapacity = 4096);
+		FrameStatsRecorder(const FrameStatsRecorder&) = delete;
+		FrameStatsRecorder(FrameStatsRecorder&&) = delete;
+		~FrameStatsRecorder();
+
+		//Columns are fixed while recording, returns the index to give to Set (the frame index is always the first column)
+		std::size_t AddColumn(std::string name);
+
+		//Queues the current row and starts a new one (with every value back to 0)
+		void EndFrame();
+
+		std::size_t GetDroppedFrameCount() const; //< since Start
+		std::uint64_t GetFrameIndex() const;
+
+		bool IsRecording() const;
+
+		//Ignored when not recording, systems running in parallel can set different columns of the same frame
+		void Set(std::size_t column, double value);
+
+		bool Start(const std::filesystem::path& filepath, FrameStatsFormat format = FrameStatsFormat::CSV);
+		//Writes the remaining rows and closes the file
+		void Stop();
+
+		FrameStatsRecorder& operator=(const FrameStatsRecorder&) = delete;
+		FrameStatsRecorder& operator=(FrameStatsRecorder&&) = delete;
+
+	private:
+		void WriteHeader();
+		void WriteRow(const double* row);
+		void WriterLoop();
+
+		std::condition_variable m_stopCondition;
+		std::mutex m_stopMutex;
+		std::ofstream m_file;
+		std::string m_lineBuffer;
+		std::thread m_writerThread;
+		std::vector<std::string> m_columnNames;
+		std::vector<double> m_currentRow;
+		std::vector<double> m_rows; //< rowCapacity rows of m_columnNames.size() values
+		std::atomic<std::size_t> m_rowHead; //< only written by EndFrame
+		std::atomic<std::size_t> m_rowTail; //< only written by the writer thread
+		std::atomic<std::size_t> m_droppedFrameCount;
+		std::size_t m_rowCapacity;
+		std::uint64_t m_frameIndex;
+		FrameStatsFormat m_format;
+		bool m_recording;
+		bool m_stopping;
+};
@@ -2,10 +2,31 @@
 
 #include <A4Engine/Export.hpp>
 #include <SDL.h>
+#include <bitset>
+#include <cstdint>
+#include <deque>
 #include <functional> //< std::function
 #include <string> //< std::string
+#include <string_view>
 #include <unordered_map> //< std::unordered_map est plus efficace que std::map pour une association clé/valeur
 
+// Indice dense d'une action, attribué à son premier usage (voir InputManager::GetActionId)
+using ActionId = unsigned int;
+
+// Nom d'action haché à la compilation : "Jump"_action ne construit aucune std::string et ne hache rien à l'exécution
+// (déclarer la variable constexpr garantit que le hachage est fait par le compilateur)
+struct ActionName
+{
+	constexpr explicit ActionName(std::string_view actionName);
+
+	std::string_view name;
+	std::uint64_t hash;
+
+	static constexpr std::uint64_t Hash(std::string_view actionName); //< FNV-1a 64 bits
+};
+
+constexpr ActionName operator""_action(const char* str, std::size_t length);
+
 enum class MouseButton
 {
 	Left,
@@ -23,47 +44,76 @@ class A4ENGINE_API InputManager
 		InputManager(InputManager&&) = delete;
 		~InputManager();
 
-		// Appuyer sur la touche "keyCode" déclenchera "action"
-		void BindKeyPressed(SDL_KeyCode keyCode, std::string action);
+		// Appuyer sur la touche "keyCode" déclenchera "action" (InvalidAction / une chaîne vide retire l'association)
+		void BindKeyPressed(SDL_KeyCode keyCode, ActionId action);
+		void BindKeyPressed(SDL_KeyCode keyCode, const std::string& action);
 
-		// Appuyer sur le bouton "button" déclenchera "action"
-		void BindMouseButtonPressed(MouseButton button, std::string action);
+		// Appuyer sur le bouton "button" déclenchera "action" (InvalidAction / une chaîne vide retire l'association)
+		void BindMouseButtonPressed(MouseButton button, ActionId action);
+		void BindMouseButtonPressed(MouseButton button, const std::string& action);
 
-		// Appuyer sur le bouton "button" du contrôleur (manette) déclenchera "action"
-		void BindControllerButton(SDL_GameControllerButton button, std::string action);
+		// Appuyer sur le bouton "button" du contrôleur (manette) déclenchera "action" (idem)
+		void BindControllerButton(SDL_GameControllerButton button, ActionId action);
+		void BindControllerButton(SDL_GameControllerButton button, const std::string& action);
 
 		// Réinitialise toutes les associations clavier/souris vers des actions
 		void ClearBindings();
 
+		// Renvoie l'indice de l'action, en l'enregistrant si c'est son premier usage
+		// les actions interrogées à chaque frame gagnent à garder cet indice : IsActive(ActionId) n'est plus qu'un test de bit
+		ActionId GetActionId(const ActionName& action);
+		ActionId GetActionId(std::string_view action);
+		const std::string& GetActionName(ActionId action) const;
+
 		// Gère l'événement de la SDL et déclenche les actions associées, s'il y en a
 		void HandleEvent(const SDL_Event& event);
 
 		// Renvoie vrai si l'action est en cours
-		bool IsActive(const std::string& action) const;
+		bool IsActive(ActionId action) const;
+		bool IsActive(const ActionName& action) const;
+		bool IsActive(const std::string& action) const; //< compatibilité, hache la chaîne à chaque appel
 
 		// Lorsque l'action "action" se déclenche, on appellera "func"
-		void OnAction(std::string action, std::function<void(bool)> func);
+		void OnAction(ActionId action, std::function<void(bool)> func);
+		void OnAction(const std::string& action, std::function<void(bool)> func);
+
+		// À appeler avant de traiter les événements d'une frame, remet à zéro les actions appuyées/relâchées
+		void NewFrame();
+
+		// Renvoie vrai si l'action a commencé/s'est arrêtée depuis le dernier NewFrame
+		bool WasPressed(ActionId action) const;
+		bool WasReleased(ActionId action) const;
 
 		InputManager& operator=(const InputManager&) = delete;
 		InputManager& operator=(InputManager&&) = delete;
 
 		static InputManager& Instance();
 
+		static constexpr ActionId InvalidAction = 0xFFFFFFFF;
+		static constexpr std::size_t MaxActionCount = 256;
+
 	private:
 		struct ActionData
 		{
 			std::function<void(bool)> func;
-			bool isActive;
+			std::string name;
 		};
 
-		ActionData& GetActionData(const std::string& action);
-		void TriggerAction(const std::string& action);
-		void ReleaseAction(const std::string& action);
+		ActionId FindActionId(std::uint64_t hash) const;
+		ActionId RegisterAction(std::string_view action, std::uint64_t hash);
+		void TriggerAction(ActionId action);
+		void ReleaseAction(ActionId action);
 
-		std::unordered_map<int /*mouseButton*/, std::string /*action*/> m_mouseButtonToAction;
-		std::unordered_map<SDL_GameControllerButton /*controllerButton*/, std::string /*action*/> m_controllerButtonToAction;
-		std::unordered_map<SDL_Keycode /*key*/, std::string /*action*/> m_keyToAction;
-		std::unordered_map<std::string /*action*/, ActionData> m_actions;
+		std::bitset<MaxActionCount> m_activeActions;
+		std::bitset<MaxActionCount> m_pressedActions; //< depuis le dernier NewFrame
+		std::bitset<MaxActionCount> m_releasedActions;
+		std::unordered_map<int /*mouseButton*/, ActionId> m_mouseButtonToAction;
+		std::unordered_map<SDL_GameControllerButton /*controllerButton*/, ActionId> m_controllerButtonToAction;
+		std::unordered_map<SDL_Keycode /*key*/, ActionId> m_keyToAction;
+		std::unordered_map<std::uint64_t /*hash du nom*/, ActionId> m_actionIds;
+		std::deque<ActionData> m_actions; //< indexé par ActionId, un deque garde les références valides si un callback enregistre une action
 
 		static InputManager* s_instance;
-};
\ No newline at end of file
+};
+
+#include <A4Engine/InputManager.inl>
@@ -0,0 +1,22 @@
+constexpr ActionName::ActionName(std::string_view actionName) :
+name(actionName),
+hash(Hash(actionName))
+{
+}
+
+constexpr std::uint64_t ActionName::Hash(std::string_view actionName)
+{
+	std::uint64_t hash = 14695981039346656037ull;
+	for (char c : actionName)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+constexpr ActionName operator""_action(const char* str, std::size_t length)
+{
+	return ActionName(std::string_view(str, length));
+}
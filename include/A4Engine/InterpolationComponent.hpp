@@ -0,0 +1,12 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <A4Engine/Vector2.hpp>
+
+// State of the Transform before the last fixed step, RenderSystem draws the entity between this and its current Transform
+// (filled by PhysicsSystem for rigid bodies, which also seeds it from the Transform when it's added so a new entity isn't drawn from the origin)
+struct A4ENGINE_API InterpolationComponent
+{
+	Vector2f previousPosition = Vector2f(0.f, 0.f);
+	float previousRotation = 0.f;
+};
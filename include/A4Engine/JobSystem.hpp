@@ -0,0 +1,139 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <entt/fwd.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// Number of jobs not done yet, jobs can be scheduled to start once a counter gets back to zero.
+// Use JobSystem::Wait (not IsDone) before destroying a counter
+class A4ENGINE_API JobCounter
+{
+	friend JobSystem;
+
+public:
+	JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter(JobCounter&&) = delete;
+	~JobCounter() = default;
+
+	bool IsDone() const;
+
+	JobCounter& operator=(const JobCounter&) = delete;
+	JobCounter& operator=(JobCounter&&) = delete;
+
+private:
+	struct Continuation
+	{
+		std::function<void()> function;
+		JobCounter* counter;
+	};
+
+	std::atomic<std::size_t> m_pendingCount{ 0 };
+	std::mutex m_continuationMutex;
+	std::vector<Continuation> m_continuations; //< jobs waiting for this counter
+};
+
+// Work stealing scheduler: each worker pops its own jobs from the back of its queue (most recent first, still in cache)
+// and steals from the front of the others' when it runs out.
+// Jobs touching SDL (rendering, windows, events) must go through ScheduleOnMainThread
+class A4ENGINE_API JobSystem
+{
+public:
+	//workerCount = 0 for one worker per core, minus the main thread
+	JobSystem(unsigned int workerCount = 0);
+	JobSystem(const JobSystem&) = delete;
+	JobSystem(JobSystem&&) = delete;
+	~JobSystem();
+
+	unsigned int GetWorkerCount() const;
+
+	bool IsMainThread() const;
+
+	//Main thread jobs run here (once per frame) or in Wait when it's called from the main thread
+	void RunMainThreadJobs();
+
+	//counter (optional) is incremented right away and decremented once the job has run
+	void Schedule(std::function<void()> job, JobCounter* counter = nullptr);
+	void ScheduleAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter = nullptr);
+	void ScheduleOnMainThread(std::function<void()> job, JobCounter* counter = nullptr);
+
+	//Runs other jobs until the counter is done, so waiting from a job doesn't block a worker
+	void Wait(JobCounter& counter);
+
+	JobSystem& operator=(const JobSystem&) = delete;
+	JobSystem& operator=(JobSystem&&) = delete;
+
+	static JobSystem& Instance();
+	static JobSystem* TryInstance(); //< nullptr if no JobSystem has been created
+
+	//0 for threads which aren't workers (such as the main thread), worker index + 1 otherwise
+	static unsigned int GetCurrentThreadIndex();
+
+	//function(index) is called for every index in [0, count[, by chunks of chunkSize indices.
+	//Without a JobSystem (or with a single chunk) everything runs on the calling thread
+	template<typename F> static void ParallelFor(std::size_t count, F&& function, std::size_t chunkSize = DefaultChunkSize);
+	//function(entity) for every entity of an entt view, the function must only touch the components of that entity
+	template<typename View, typename F> static void ParallelForEach(const View& view, F&& function, std::size_t chunkSize = DefaultChunkSize);
+
+	static constexpr std::size_t DefaultChunkSize = 256;
+
+private:
+	struct Job
+	{
+		std::function<void()> function;
+		JobCounter* counter;
+	};
+
+	// Ring buffer which only grows: once it has held as many jobs as a frame queues, pushing and popping don't allocate anymore
+	class JobQueue
+	{
+	public:
+		bool IsEmpty() const;
+		Job PopBack();
+		Job PopFront();
+		void PushBack(Job job);
+
+	private:
+		std::vector<Job> m_jobs;
+		std::size_t m_first = 0;
+		std::size_t m_count = 0;
+	};
+
+	struct Worker
+	{
+		JobQueue jobs;
+		std::mutex mutex;
+		std::thread thread;
+	};
+
+	void DrainJobs();
+	void Push(Job job);
+	void Run(Job& job);
+	bool TryPop(std::size_t workerIndex, Job& job);
+	bool TryRunJob();
+	bool TrySteal(std::size_t thiefIndex, Job& job);
+	void WorkerLoop(std::size_t workerIndex);
+
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	std::vector<Job> m_mainThreadJobs;
+	std::mutex m_mainThreadMutex;
+	std::thread::id m_mainThreadId;
+
+	std::atomic<std::size_t> m_queuedJobCount;
+	std::atomic<std::size_t> m_nextWorker;
+	std::condition_variable m_wakeCondition;
+	std::mutex m_wakeMutex;
+	bool m_running;
+
+	static JobSystem* s_instance;
+};
+
+#include <A4Engine/JobSystem.inl>
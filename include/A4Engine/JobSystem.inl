@@ -0,0 +1,62 @@
+#include <A4Engine/FrameArena.hpp>
+#include <algorithm>
+#include <memory_resource>
+#include <type_traits>
+
+template<typename F>
+void JobSystem::ParallelFor(std::size_t count, F&& function, std::size_t chunkSize)
+{
+	chunkSize = std::max<std::size_t>(chunkSize, 1);
+	if (!s_instance || count <= chunkSize)
+	{
+		for (std::size_t i = 0; i < count; ++i)
+			function(i);
+
+		return;
+	}
+
+	struct ChunkedLoop
+	{
+		std::remove_reference_t<F>* function;
+		std::size_t count;
+		std::size_t chunkSize;
+	};
+
+	ChunkedLoop loop{ &function, count, chunkSize };
+
+	// Chunk jobs only capture a pointer and an index: std::function keeps them in its small buffer instead of allocating
+	JobCounter counter;
+	for (std::size_t first = 0; first < count; first += chunkSize)
+	{
+		s_instance->Schedule([&loop, first]
+		{
+			std::size_t last = std::min(first + loop.chunkSize, loop.count);
+			for (std::size_t i = first; i < last; ++i)
+				(*loop.function)(i);
+		}, &counter);
+	}
+
+	// The calling thread takes chunks too while it waits
+	s_instance->Wait(counter);
+}
+
+template<typename View, typename F>
+void JobSystem::ParallelForEach(const View& view, F&& function, std::size_t chunkSize)
+{
+	chunkSize = std::max<std::size_t>(chunkSize, 1);
+	if (!s_instance || view.size_hint() <= chunkSize)
+	{
+		for (entt::entity entity : view)
+			function(entity);
+
+		return;
+	}
+
+	// Views over several components can only be walked forward, their entities are gathered first (in frame memory)
+	std::pmr::vector<entt::entity> entities(FrameArena::GetResource());
+	entities.reserve(view.size_hint());
+	for (entt::entity entity : view)
+		entities.push_back(entity);
+
+	ParallelFor(entities.size(), [&](std::size_t i) { function(entities[i]); }, chunkSize);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Allocations only bump an offset in a block, deallocations do nothing: memory is released all at once by Reset.
+// Not thread-safe, see FrameArena for one arena per thread
+class A4ENGINE_API LinearArena : public std::pmr::memory_resource
+{
+	public:
+		LinearArena(std::size_t blockSize = 64 * 1024, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+		LinearArena(const LinearArena&) = delete;
+		LinearArena(LinearArena&&) = delete;
+		~LinearArena();
+
+		std::size_t GetCapacity() const; //< bytes in blocks
+		std::size_t GetPeakUsage() const;
+		std::size_t GetUsage() const; //< bytes handed out (with alignment padding) since the last Reset
+
+		//Invalidates every allocation. Blocks are kept, merged into one when the arena overflowed so the next frames stay in a single block,
+		//and shrunk when a spike (a level load) left one much bigger than what the last resets needed
+		void Reset();
+
+		LinearArena& operator=(const LinearArena&) = delete;
+		LinearArena& operator=(LinearArena&&) = delete;
+
+	protected:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+		void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+	private:
+		struct Block
+		{
+			std::byte* data;
+			std::size_t size;
+		};
+
+		void AddBlock(std::size_t minSize);
+		void ReleaseBlocks();
+
+		std::pmr::memory_resource* m_upstream;
+		std::vector<Block> m_blocks; //< only the last one is allocated from
+		std::size_t m_blockSize;
+		std::size_t m_nextBlockSize;
+		std::size_t m_offset; //< in the last block
+		std::size_t m_peakUsage;
+		std::size_t m_recentUsage; //< decaying maximum of the usage at each Reset
+		std::size_t m_usage;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <A4Engine/Export.hpp>
+#include <cstdint>
+#include <cstddef>
+
+// Read-only view of a whole file mapped in memory, the OS pages it in on demand instead of copying it
+class A4ENGINE_API MappedFile
+{
+public:
+	MappedFile(const char* path);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&& file) noexcept;
+	~MappedFile();
+
+	const std::uint8_t* GetData() const;
+	std::size_t GetSize() const;
+
+	bool IsValid() const;
+
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&& file) noexcept;
+
+private:
+	void Close();
+
+	const std::uint8_t* m_data;
+	std::size_t m_size;
+#ifdef _WIN32
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#endif
+};
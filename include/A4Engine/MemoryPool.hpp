@@ -0,0 +1,41 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Fixed-size slots allocated by blocks and recycled through a free list:
+// once enough blocks exist, allocating and freeing never touch the heap again
+class A4ENGINE_API MemoryPool
+{
+public:
+	MemoryPool(std::size_t slotSize, std::size_t slotsPerBlock = 256);
+	MemoryPool(const MemoryPool&) = delete;
+	MemoryPool(MemoryPool&& pool) noexcept;
+	~MemoryPool();
+
+	void* Allocate();
+	void Free(void* slot);
+
+	std::size_t GetAllocatedCount() const;
+	std::size_t GetCapacity() const;
+	std::size_t GetSlotSize() const;
+
+	MemoryPool& operator=(const MemoryPool&) = delete;
+	MemoryPool& operator=(MemoryPool&& pool) noexcept;
+
+private:
+	struct FreeSlot
+	{
+		FreeSlot* next;
+	};
+
+	void AddBlock();
+
+	std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+	FreeSlot* m_freeList;
+	std::size_t m_allocatedCount;
+	std::size_t m_slotSize;
+	std::size_t m_slotsPerBlock;
+};
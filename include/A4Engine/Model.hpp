@@ -34,6 +34,10 @@ class A4ENGINE_API Model : public Renderable // Un ensemble de triangles
 		//void Draw(SDLppRenderer& renderer, const Transform& cameraTransform, const Transform& transform) override;
 		void Draw(SDLppRenderer& renderer, const Matrix3& transformMatrix) override;
 
+		const std::vector<int>& GetIndices() const;
+		std::size_t GetMemoryUsage() const; //< bytes, the texture isn't counted
+		const std::vector<ModelVertex>& GetVertices() const;
+
 		bool IsValid() const;
 
 		bool SaveToFile(const std::filesystem::path& filepath) const;
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <array>
+#include <vector>
+
+class PhysicsSystem;
+class SDLppRenderer;
+class SystemScheduler;
+
+// ImGui window showing frame times (graph, histogram, percentiles), system timings, the profiler zones of the last frames,
+// renderer counters, allocations, resource memory and physics stats. Every buffer is allocated up front, sampling a frame doesn't allocate
+class A4ENGINE_API PerformanceOverlay
+{
+	public:
+		PerformanceOverlay(std::size_t frameCapacity = 600);
+		PerformanceOverlay(const PerformanceOverlay&) = delete;
+		PerformanceOverlay(PerformanceOverlay&&) = delete;
+		~PerformanceOverlay() = default;
+
+		//Once per frame, frameTime in seconds. Zones are read from the Profiler (the ones of the frame it ended last), system times from the scheduler (its last Run)
+		void AddFrame(float frameTime);
+
+		//Between SDLppImGui::NewFrame and SDLppImGui::Render
+		void Draw();
+
+		void SetPhysicsSystem(const PhysicsSystem* physicsSystem);
+		void SetRenderer(const SDLppRenderer* renderer);
+		void SetSystemScheduler(const SystemScheduler* systemScheduler); //< system times don't need the profiling option
+
+		PerformanceOverlay& operator=(const PerformanceOverlay&) = delete;
+		PerformanceOverlay& operator=(PerformanceOverlay&&) = delete;
+
+		static constexpr std::size_t HistogramBucketCount = 32;
+		static constexpr std::size_t MaxZoneCount = 64;
+
+	private:
+		struct ZoneTiming
+		{
+			const char* name;
+			float averageTime; //< ms per frame, smoothed over the last frames
+			unsigned int callCount; //< during the last frame
+		};
+
+		void DrawAllocations();
+		void DrawFrameTimes();
+		void DrawPhysics();
+		void DrawRenderer();
+		void DrawResources();
+		void DrawSystems();
+		void DrawZones();
+		void UpdateSystems();
+		void UpdateZones();
+
+		std::array<float, HistogramBucketCount> m_histogram;
+		std::vector<float> m_frameTimes; //< ring buffer, in milliseconds
+		std::vector<float> m_sortedFrameTimes;
+		std::vector<float> m_systemTimes; //< ms per frame of each system, smoothed over the last frames
+		std::vector<float> m_zoneFrameTimes; //< time of each zone during the frame being read
+		std::vector<ZoneTiming> m_zones;
+		std::size_t m_frameCount;
+		std::size_t m_nextFrame;
+		const PhysicsSystem* m_physicsSystem;
+		const SDLppRenderer* m_renderer;
+		const SystemScheduler* m_systemScheduler;
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <A4Engine/Vector2.hpp>
+#include <chipmunk/chipmunk.h>
+#include <entt/fwd.hpp>
+#include <cstddef>
+
+// Inputs and outputs of the PhysicsSystem batch queries, entities are entt::null for shapes of bodies without a RigidBodyComponent
+
+struct RaycastQuery
+{
+	Vector2f from;
+	Vector2f to;
+	float radius = 0.f; //< > 0 sweeps a circle instead of a thin ray
+};
+
+struct RaycastHit
+{
+	entt::entity entity;
+	cpShape* shape; //< nullptr when nothing was hit
+	Vector2f point;
+	Vector2f normal;
+	float fraction; //< along the ray, 1 when nothing was hit
+};
+
+struct BoxQuery
+{
+	Vector2f min;
+	Vector2f max;
+};
+
+// Where the entities found by a box query are in the caller's entity buffer
+struct BoxQueryResult
+{
+	std::size_t first;
+	std::size_t count;
+	bool truncated; //< the entity buffer was full, some entities are missing
+};
+
+struct PointQuery
+{
+	Vector2f position;
+	float maxDistance = 0.f; //< 0 = only shapes containing the point
+};
+
+struct PointQueryHit
+{
+	entt::entity entity;
+	cpShape* shape; //< nullptr when no shape is close enough
+	Vector2f point; //< closest point on the shape
+	float distance; //< negative inside the shape
+};
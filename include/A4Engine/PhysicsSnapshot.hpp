@@ -0,0 +1,83 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <chipmunk/chipmunk.h>
+#include <entt/fwd.hpp>
+#include <cstdint>
+#include <vector>
+
+// Raw Chipmunk values (cpFloat, not float) so that restoring a state is bit exact
+struct PhysicsBodyState
+{
+	entt::entity entity;
+	cpBody* body;
+	std::uint64_t bodySerial; //< the pool reuses body addresses, see RigidBodyComponent::GetSerial
+	cpVect position;
+	cpVect velocity;
+	cpVect force;
+	cpFloat angle;
+	cpFloat angularVelocity;
+	cpFloat torque;
+	cpFloat idleTime;
+	bool sleeping;
+};
+
+// Warm starting impulses of a contact, shapes are stored in address order (tangentImpulse is flipped accordingly)
+struct PhysicsContactState
+{
+	const cpShape* shapeA;
+	const cpShape* shapeB;
+	cpHashValue hash;
+	cpFloat normalImpulse;
+	cpFloat tangentImpulse;
+};
+
+struct PhysicsSnapshot
+{
+	std::uint64_t step = 0; //< PhysicsSystem::GetStepIndex() when saved
+	std::uint64_t hash = 0; //< of the body states, see PhysicsSystem::ComputeStateHash
+	float timeStep = 0.f;   //< of the step which led to this state
+	std::vector<PhysicsBodyState> bodies;
+	std::vector<PhysicsContactState> contacts; //< sorted, for lookups when restoring
+};
+
+struct PhysicsDeterminismReport
+{
+	std::size_t checkedStepCount = 0;
+	std::uint64_t firstMismatchStep = 0; //< only meaningful if !deterministic
+	bool deterministic = true;
+};
+
+// Preallocated frames for rollback/replay: once the body and contact counts stay under the capacities given here
+// (or reached once), saving a frame doesn't allocate
+class A4ENGINE_API PhysicsSnapshotRing
+{
+public:
+	PhysicsSnapshotRing(std::size_t frameCapacity, std::size_t bodyCapacity = 256, std::size_t contactCapacity = 1024);
+	PhysicsSnapshotRing(const PhysicsSnapshotRing&) = delete;
+	PhysicsSnapshotRing(PhysicsSnapshotRing&&) = default;
+	~PhysicsSnapshotRing() = default;
+
+	void Clear();
+	//Frames after this step belong to a future which has been rolled back
+	void DiscardAfter(std::uint64_t step);
+
+	//nullptr if the step isn't (or isn't anymore) in the ring
+	const PhysicsSnapshot* Find(std::uint64_t step) const;
+
+	std::size_t GetFrameCapacity() const;
+	std::size_t GetFrameCount() const;
+	const PhysicsSnapshot& GetFrame(std::size_t index) const; //< 0 = oldest
+	std::size_t GetMemoryUsage() const; //< bytes reserved by every frame
+
+	//Frame to fill (with PhysicsSystem::SaveSnapshot), the oldest one is reused once the ring is full
+	PhysicsSnapshot& Push();
+
+	PhysicsSnapshotRing& operator=(const PhysicsSnapshotRing&) = delete;
+	PhysicsSnapshotRing& operator=(PhysicsSnapshotRing&&) = default;
+
+private:
+	std::vector<PhysicsSnapshot> m_frames;
+	std::size_t m_firstFrame;
+	std::size_t m_frameCount;
+};
@@ -3,14 +3,51 @@
 #include <A4Engine/Export.hpp>
 #include <entt/fwd.hpp>
 #include <chipmunk/chipmunk.h>
+#include <A4Engine/CollisionEvent.hpp>
+#include <A4Engine/CollisionLayerTable.hpp>
+#include <A4Engine/MemoryPool.hpp>
+#include <A4Engine/PhysicsQueries.hpp>
+#include <A4Engine/PhysicsSnapshot.hpp>
 #include <A4Engine/RigidBodyComponent.h>
 #include <vector>
 
+enum class PhysicsBroadphase
+{
+	BBTree,         //< Chipmunk's default, best when shape sizes vary a lot
+	SpatialHash,    //< fixed grid, best for many shapes of similar size (cell size and count from the settings)
+	AutoSpatialHash //< spatial hash tuned from the shapes in the space, tuned again when their count changes a lot
+};
+
+struct PhysicsSettings
+{
+	PhysicsBroadphase broadphase = PhysicsBroadphase::BBTree;
+	float spatialHashCellSize = 50.f; //< should be around the size of a typical shape
+	int spatialHashCellCount = 1000;  //< around 10 times the shape count
+
+	//1 = plain cpSpace, more uses Chipmunk's threaded solver (cpHastySpace), 0 = as many threads as cores
+	//Chipmunk caps its solver to 2 threads and only splits the work once a scene has enough contacts
+	unsigned int threadCount = 1;
+	int iterations = 10; //< solver iterations per step, more = stiffer stacks but slower
+	float sleepTimeThreshold = 0.5f; //< seconds a body must stay idle before sleeping, infinity disables sleeping
+	float idleSpeedThreshold = 0.f; //< speed under which a body is idle, 0 = estimated from gravity
+	std::size_t collisionEventCapacity = 1024; //< events past this count are dropped, the buffer never grows during a step
+	bool postSolveEvents = false; //< one event per touching pair and per step, can quickly fill the buffer
+};
+
+struct PhysicsStats
+{
+	std::size_t movedBodyCount = 0;
+	std::size_t collidingPairCount = 0; //< shape pairs touching after the step (Chipmunk doesn't expose how many pairs its broadphase tested)
+	std::size_t contactCount = 0;
+	float spatialHashCellSize = 0.f; //< 0 with the BB tree
+	int spatialHashCellCount = 0;
+};
+
 class A4ENGINE_API PhysicsSystem {
 public:
 
-	//deltaTimeStep is the step between each update
 	PhysicsSystem(entt::registry& registry);
+	PhysicsSystem(entt::registry& registry, const PhysicsSettings& settings);
 	PhysicsSystem(const PhysicsSystem&) = delete;
 	PhysicsSystem(PhysicsSystem&&) = delete;
 	~PhysicsSystem();
@@ -18,22 +55,109 @@ public:
 	PhysicsSystem& operator=(const PhysicsSystem&) = delete;
 	PhysicsSystem& operator=(PhysicsSystem&&) = delete;
 
+	unsigned int AddCollisionLayer(std::string name);
+
+	PhysicsBroadphase GetBroadphase() const;
+	//Events of the last step only (cleared when the next one starts): systems reading them should run right after FixedUpdate.
+	//Shapes removed between steps don't produce Separate events
+	const std::vector<CollisionEvent>& GetCollisionEvents() const;
+	const CollisionLayerTable& GetCollisionLayers() const;
+	std::size_t GetDroppedCollisionEventCount() const; //< during the last step, because the buffer was full
+	std::size_t GetPoolCapacity() const; //< bodies + shapes the pools can hold before allocating again
 	cpSpace* GetSpace();
+	const PhysicsStats& GetStats() const; //< of the last step
+	std::uint64_t GetStepIndex() const; //< FixedUpdate count, snapshots are identified by it
 
 	float GetGravity();
 	float GetDamping();
+	float GetIdleSpeedThreshold();
+	int GetIterations();
+	float GetSleepTimeThreshold();
+	unsigned int GetThreadCount();
 	void SetGravity(float value);
 	void SetDamping(float value);
+	void SetIdleSpeedThreshold(float speed);
+	void SetIterations(int iterations);
+	//Filters of the shapes already in the space are updated
+	void SetLayersCollide(unsigned int firstLayer, unsigned int secondLayer, bool collide);
+	void SetSleepTimeThreshold(float seconds);
+
+	//Bodies and shapes taken from the pools of this system and added to its space (RigidBodyComponent does it for entities),
+	//they have to be destroyed through the system too
+	cpBody* CreateBody(float mass, float moment);
+	//defaultLayer is used when the shape has no collision layer of its own
+	cpShape* CreateShape(cpBody* body, const Shape& shape, unsigned int defaultLayer = CollisionLayerTable::DefaultLayer);
+	void DestroyBody(cpBody* body);
+	void DestroyShape(cpShape* shape);
+
+	//entt::null for bodies that don't belong to a RigidBodyComponent
+	static entt::entity GetBodyEntity(const cpBody* body);
+
+	//Batch queries against the space as it was after the last step, shapes are filtered as if the query was a shape of the given layer (sensors are ignored).
+	//They only read the space: with the BB tree broadphase, batches are split over the JobSystem workers (when there is one), no step
+	//or body/shape change must run at the same time (the spatial hash updates its stamps while querying, it stays on the calling thread).
+	//Each query's entities are sorted and unique; a split box batch gives each chunk of queries an equal share of the entity buffer
+	void QueryBoxes(const BoxQuery* queries, std::size_t queryCount, BoxQueryResult* results, entt::entity* entities, std::size_t entityCapacity, unsigned int layer = CollisionLayerTable::DefaultLayer) const;
+	void QueryNearestPoints(const PointQuery* queries, std::size_t queryCount, PointQueryHit* hits, unsigned int layer = CollisionLayerTable::DefaultLayer) const;
+	void Raycast(const RaycastQuery* queries, std::size_t queryCount, RaycastHit* hits, unsigned int layer = CollisionLayerTable::DefaultLayer) const;
 
-	void Step(float deltaTime);
+	bool AreQueriesThreadSafe() const;
 
-	void FixedUpdate(float deltaTime);
+	//Rollback/replay: saves the bodies of every RigidBodyComponent (bodies without an entity aren't part of it) and the warm starting
+	//impulses of the touching pairs, as they are after the last step
+	void SaveSnapshot(PhysicsSnapshot& snapshot) const;
+	//Entities created since the snapshot are left as they are, those destroyed are skipped; Transforms are updated without interpolation.
+	//Contacts of pairs which stopped touching since can't be warm started again (Chipmunk keeps them in a private cache),
+	//returns how many were restored
+	std::size_t RestoreSnapshot(const PhysicsSnapshot& snapshot);
+	//Hash of the body states in the same order and precision as a snapshot, they only match if the simulation is bit exact
+	std::uint64_t ComputeStateHash() const;
+	//Restores the oldest frame of the ring, steps again through the next ones and compares the hashes. Nothing else may drive the bodies
+	//meanwhile (inputs, systems): the ring must hold consecutive steps and its newest frame must be the current state, which is restored at the end
+	PhysicsDeterminismReport CheckDeterminism(const PhysicsSnapshotRing& ring);
+
+	//Chipmunk can't go back to the BB tree once a spatial hash is used
+	void UseSpatialHash(float cellSize, int cellCount);
+	//Picks the cell size from the median size of dynamic shapes and the cell count from the shape count
+	void TuneSpatialHash();
+
+	//Steps the space once, meant to be run by a FixedStepScheduler
+	//Only the Transforms of bodies Chipmunk actually moved are written, sleeping and static bodies cost nothing
+	void FixedUpdate(float timeStep);
 
 private:
+	void OnInterpolationConstruct(entt::registry& registry, entt::entity entity);
+	void OnRigidBodyConstruct(entt::registry& registry, entt::entity entity);
+
+	void PushCollisionEvent(CollisionEventType type, cpArbiter* arbiter);
+
+	static cpBool OnCollisionBegin(cpArbiter* arbiter, cpSpace* space, cpDataPointer userData);
+	static void OnCollisionPostSolve(cpArbiter* arbiter, cpSpace* space, cpDataPointer userData);
+	static void OnCollisionSeparate(cpArbiter* arbiter, cpSpace* space, cpDataPointer userData);
+	static void UpdateBodyPosition(cpBody* body, cpFloat timeStep);
+
+	void UpdateStats();
+
 	cpSpace* m_space;
 	entt::registry& m_registry;
+	bool m_threaded;
+
+	CollisionLayerTable m_collisionLayers;
+	PhysicsBroadphase m_broadphase;
+	PhysicsStats m_stats;
+	std::size_t m_tunedShapeCount;
+	float m_timeSinceTuning; //< simulated seconds
+	std::uint64_t m_stepIndex;
+	float m_lastTimeStep;
 
-	float m_timeStep;
-	float m_timeAccumulator;
+	// Not on the FrameArena: both outlive the frame of their step (the next step resets the interpolation of the moved entities,
+	// events are read until the next step, which may be frames away), they keep their capacity and stop allocating instead
+	std::vector<entt::entity> m_movedEntities; //< filled by UpdateBodyPosition during the step
+	std::vector<CollisionEvent> m_collisionEvents;
+	std::size_t m_collisionEventCapacity;
+	std::size_t m_droppedCollisionEventCount;
+	bool m_stepping;
 
+	MemoryPool m_bodyPool;
+	MemoryPool m_shapePool;
 };
\ No newline at end of file
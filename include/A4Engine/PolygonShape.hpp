@@ -0,0 +1,23 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <A4Engine/Shape.h>
+#include <A4Engine/Vector2.hpp>
+#include <vector>
+
+// Convex polygon, Chipmunk takes the convex hull of the vertices if they aren't
+class A4ENGINE_API PolygonShape : public Shape
+{
+public:
+	PolygonShape(const std::vector<Vector2f>& vertices, float radius = 0.f);
+	~PolygonShape() = default;
+
+	cpShape* CreateShape(cpBody* body, void* memory) const override;
+	float GetMoment(float mass) const override;
+
+	std::size_t GetVertexCount() const;
+
+private:
+	std::vector<cpVect> m_vertices;
+	float m_radius;
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <A4Engine/AllocationTracker.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// Zones are only compiled with the "profiling" option (xmake f --profiling=y), otherwise the macros expand to nothing.
+// A4_PROFILE_ZONE names must be string literals (or live as long as the profiler), A4_PROFILE_ZONE_DYNAMIC copies its name.
+// Zones are also allocation tags when allocation tracking is compiled (see AllocationTracker)
+#ifdef A4ENGINE_PROFILING
+#define A4_PROFILE_CONCAT_IMPL(a, b) a##b
+#define A4_PROFILE_CONCAT(a, b) A4_PROFILE_CONCAT_IMPL(a, b)
+#define A4_PROFILE_ZONE(name) ProfilerScope A4_PROFILE_CONCAT(profilerScope, __LINE__)(name)
+#define A4_PROFILE_ZONE_DYNAMIC(name) ProfilerScope A4_PROFILE_CONCAT(profilerScope, __LINE__)(Profiler::Intern(name))
+#elif defined(A4ENGINE_ALLOCATION_TRACKING)
+#define A4_PROFILE_ZONE(name) A4_ALLOCATION_TAG(name)
+#define A4_PROFILE_ZONE_DYNAMIC(name) A4_ALLOCATION_TAG(Profiler::Intern(name))
+#else
+#define A4_PROFILE_ZONE(name) do {} while (false)
+#define A4_PROFILE_ZONE_DYNAMIC(name) do {} while (false)
+#endif
+
+struct ProfilerEvent
+{
+	const char* name;
+	std::uint64_t start; //< Profiler::Now()
+	std::uint64_t end;
+	unsigned int threadId; //< in registration order, see Profiler::GetThreadName
+};
+
+struct ProfilerThreadBuffer;
+
+// Each thread records its zones into its own ring buffer (single producer/single consumer, no lock),
+// EndFrame moves them to a preallocated history which is what gets exported. A full thread buffer drops its new events
+class A4ENGINE_API Profiler
+{
+	public:
+		Profiler(std::size_t historyCapacity = 256 * 1024, std::size_t threadEventCapacity = 16 * 1024);
+		Profiler(const Profiler&) = delete;
+		Profiler(Profiler&&) = delete;
+		~Profiler();
+
+		//Records the frame as a zone of the main thread and collects the events of every thread, once per frame
+		void EndFrame();
+
+		//Chrome trace event format, opens in chrome://tracing or ui.perfetto.dev
+		bool ExportChromeTrace(const std::string& filepath);
+
+		std::size_t GetDroppedEventCount() const;
+		std::size_t GetEventCount() const; //< in the history
+		const ProfilerEvent& GetEvent(std::size_t index) const; //< 0 = oldest
+		std::size_t GetLastFrameEventCount() const; //< collected by the last EndFrame, they are the newest events of the history
+		std::string GetThreadName(unsigned int threadId) const;
+
+		void Record(const char* name, std::uint64_t start, std::uint64_t end);
+
+		//Exported when the profiler is destroyed, empty to disable
+		void SetExportOnExit(std::string filepath);
+
+		Profiler& operator=(const Profiler&) = delete;
+		Profiler& operator=(Profiler&&) = delete;
+
+		static Profiler& Instance();
+		//Returns a copy of name living as long as the profiler, nullptr if there is no profiler
+		static const char* Intern(std::string_view name);
+		static bool IsEnabled(); //< a profiler exists
+		static std::uint64_t Now(); //< in nanoseconds
+
+	private:
+		std::size_t Collect(); //< returns how many events were collected
+		ProfilerThreadBuffer& GetThreadBuffer();
+
+		std::vector<std::unique_ptr<ProfilerThreadBuffer>> m_threadBuffers;
+		std::vector<ProfilerEvent> m_history;
+		std::unordered_set<std::string> m_internedNames;
+		std::string m_exportPath;
+		std::thread::id m_mainThreadId;
+		mutable std::mutex m_collectMutex;
+		mutable std::mutex m_internMutex;
+		mutable std::mutex m_threadMutex;
+		std::size_t m_historyFirst;
+		std::size_t m_historyCount;
+		std::size_t m_lastFrameEventCount;
+		std::size_t m_threadEventCapacity;
+		std::uint64_t m_frameStart;
+		std::uint64_t m_generation;
+		std::uint64_t m_startTime;
+
+		static Profiler* s_instance;
+};
+
+// Measures its own lifetime (and tags the allocations made meanwhile)
+class ProfilerScope
+{
+	public:
+		inline explicit ProfilerScope(const char* name);
+		ProfilerScope(const ProfilerScope&) = delete;
+		ProfilerScope(ProfilerScope&&) = delete;
+		inline ~ProfilerScope();
+
+		ProfilerScope& operator=(const ProfilerScope&) = delete;
+		ProfilerScope& operator=(ProfilerScope&&) = delete;
+
+	private:
+		const char* m_name;
+		std::uint64_t m_start;
+};
+
+#include <A4Engine/Profiler.inl>
@@ -0,0 +1,19 @@
+ProfilerScope::ProfilerScope(const char* name) :
+m_name((name && Profiler::IsEnabled()) ? name : nullptr),
+m_start((m_name) ? Profiler::Now() : 0)
+{
+#ifdef A4ENGINE_ALLOCATION_TRACKING
+	AllocationTracker::PushTag(name);
+#endif
+}
+
+ProfilerScope::~ProfilerScope()
+{
+	// The profiler may have been destroyed in between
+	if (m_name && Profiler::IsEnabled())
+		Profiler::Instance().Record(m_name, m_start, Profiler::Now());
+
+#ifdef A4ENGINE_ALLOCATION_TRACKING
+	AllocationTracker::PopTag();
+#endif
+}
@@ -10,7 +10,8 @@ class A4ENGINE_API RenderSystem
 	public:
 		RenderSystem(SDLppRenderer& renderer, entt::registry& registry);
 
-		void Update(float deltaTime);
+		// interpolationAlpha : position entre l'tat prcdent et l'tat courant des entits ayant un InterpolationComponent (voir FixedStepScheduler::GetAlpha)
+		void Update(float deltaTime, float interpolationAlpha = 1.f);
 
 	private:
 		SDLppRenderer& m_renderer;
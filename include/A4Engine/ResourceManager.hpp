@@ -5,11 +5,26 @@
 #include <string> //< std::string
 #include <unordered_map> //< std::unordered_map est plus efficace que std::map pour une association cl�/valeur
 
+class CollisionGeometry;
 class Sound;
 class Model;
 class SDLppRenderer;
 class SDLppTexture;
 
+struct ResourceClassUsage
+{
+	std::size_t count = 0;
+	std::size_t memory = 0; //< bytes, see the GetMemoryUsage of each resource class
+};
+
+struct ResourceMemoryUsage
+{
+	ResourceClassUsage collisionGeometries;
+	ResourceClassUsage models;
+	ResourceClassUsage sounds;
+	ResourceClassUsage textures;
+};
+
 class A4ENGINE_API ResourceManager
 {
 	public:
@@ -20,9 +35,12 @@ class A4ENGINE_API ResourceManager
 
 		void Clear();
 
+		//assetPath is a model or an image, see CollisionGeometry
+		const std::shared_ptr<CollisionGeometry>& GetCollisionGeometry(const std::string& assetPath);
 		const std::shared_ptr<Model>& GetModel(const std::string& modelPath);
 		const std::shared_ptr<SDLppTexture>& GetTexture(const std::string& texturePath);
 		const std::shared_ptr<Sound>& GetSound(const char* soundPath);
+		ResourceMemoryUsage GetMemoryUsage() const;
 
 		void Purge();
 
@@ -32,9 +50,11 @@ class A4ENGINE_API ResourceManager
 		ResourceManager& operator=(ResourceManager&&) = delete;
 
 	private:
+		std::shared_ptr<CollisionGeometry> m_missingCollisionGeometry;
 		std::shared_ptr<Model> m_missingModel;
 		std::shared_ptr<SDLppTexture> m_missingTexture;
 		std::shared_ptr<Sound> m_missingSound;
+		std::unordered_map<std::string /*assetPath*/, std::shared_ptr<CollisionGeometry>> m_collisionGeometries;
 		std::unordered_map<std::string /*modelPath*/, std::shared_ptr<Model>> m_models;
 		std::unordered_map<std::string /*texturePath*/, std::shared_ptr<SDLppTexture>> m_textures;
 		std::unordered_map<std::string /*SoundPath*/, std::shared_ptr<Sound>> m_sounds;
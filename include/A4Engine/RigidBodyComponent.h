@@ -2,37 +2,58 @@
 
 #include <A4Engine/Export.hpp>
 #include <chipmunk/chipmunk.h>
-#include <A4Engine/Shape.h>
-#include <memory>
-#include <vector>
+#include <cstdint>
 
+class PhysicsSystem;
+class Shape;
+struct PhysicsBodyState;
+
+// Owns a body (and its shapes) allocated from the PhysicsSystem pools, everything is removed from the space
+// and given back to the pools when the component is destroyed.
+// Must not be destroyed from inside a Chipmunk callback (the space is locked during a step)
 class A4ENGINE_API RigidBodyComponent {
 public:
 
-	RigidBodyComponent(float mass);
-	RigidBodyComponent(const RigidBodyComponent&) = default;
-	RigidBodyComponent(RigidBodyComponent&&) = default;
+	RigidBodyComponent(PhysicsSystem& physicsSystem, float mass);
+	RigidBodyComponent(const RigidBodyComponent&) = delete;
+	RigidBodyComponent(RigidBodyComponent&& rigidBody) noexcept;
 	~RigidBodyComponent();
 
-	RigidBodyComponent& operator=(const RigidBodyComponent&) = default;
-	RigidBodyComponent& operator=(RigidBodyComponent&&) = default;
+	RigidBodyComponent& operator=(const RigidBodyComponent&) = delete;
+	RigidBodyComponent& operator=(RigidBodyComponent&& rigidBody) noexcept;
 
 	cpBody* GetBody();
-	void SetBody(cpBody* body);
+	unsigned int GetCollisionLayer() const;
+	//Unique to each created body, unlike its address which a later body may get from the pool
+	std::uint64_t GetSerial() const;
 
 	cpVect GetPosition();
 	float GetAngle();
 	void SetPosition(cpVect pos);
 	void SetAngle(float angle);
 
-	void SetMoment();
+	//Moves every shape of the body to this layer, shapes added later without a layer of their own get it too
+	void SetCollisionLayer(unsigned int layer);
+
+	//Shapes added so far contribute to the moment, removing a shape doesn't change it
+	void SetMoment(float moment);
 
-	void AddShape(cpSpace* space, Shape* shape);
-	void RemoveShape(Shape* shape);
+	cpShape* AddShape(const Shape& shape);
+	void RemoveShape(cpShape* shape);
 
-	void CleanShapeBank(cpSpace* space);
+	//Everything Chipmunk integrates (state.entity isn't touched), see PhysicsSystem::SaveSnapshot
+	void SaveState(PhysicsBodyState& state) const;
+	//Position and velocities, returns false if they were already the current ones (the body is left untouched)
+	bool RestoreState(const PhysicsBodyState& state);
+	//Idle time and sleeping, to do once every body has been restored: moving a body wakes up those it sleeps with
+	void RestoreSleepState(const PhysicsBodyState& state);
 
 private:
+	void Release();
+
+	PhysicsSystem* m_physicsSystem;
 	cpBody* m_body;
-	std::vector<Shape*> m_shapeBank;
-};
\ No newline at end of file
+	float m_moment;
+	unsigned int m_collisionLayer;
+	std::uint64_t m_serial;
+};
@@ -2,11 +2,24 @@
 
 #include <A4Engine/Export.hpp>
 #include <SDL.h>
+#include <cstddef>
 #include <string_view>
 
 class SDLppTexture;
 class SDLppWindow;
 
+struct RendererStats
+{
+	std::size_t copyCallCount = 0;
+	std::size_t drawCallCount = 0; //< geometry + copy calls
+	std::size_t geometryCallCount = 0;
+	std::size_t indexCount = 0; //< of geometry calls
+	std::size_t textureSwitchCount = 0; //< draw calls using another texture than the previous one
+	std::size_t vertexCount = 0; //< of geometry calls
+	float clearTime = 0.f; //< in milliseconds
+	float presentTime = 0.f; //< in milliseconds, includes the wait for vsync
+};
+
 class A4ENGINE_API SDLppRenderer
 {
 	public:
@@ -16,16 +29,26 @@ class A4ENGINE_API SDLppRenderer
 		~SDLppRenderer();
 
 		void Clear();
-		SDL_Renderer* GetHandle() const;
+		const RendererStats& GetFrameStats() const; //< of the frame being drawn
+		SDL_Renderer* GetHandle() const; //< drawing through it directly isn't counted in the stats (ImGui does)
+		const RendererStats& GetLastFrameStats() const; //< of the last presented frame
+		//Stats of the current frame are kept as the last frame ones, then reset
 		void Present();
 		void RenderCopy(const SDLppTexture& texture);
 		void RenderCopy(const SDLppTexture& texture, const SDL_Rect& dst);
 		void RenderCopy(const SDLppTexture& texture, const SDL_Rect& src, const SDL_Rect& dst);
+		//texture can be null (colored triangles), without indices every three vertices make a triangle
+		void RenderGeometry(const SDLppTexture* texture, const SDL_Vertex* vertices, int vertexCount, const int* indices = nullptr, int indexCount = 0);
 		void SetDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a);
 
 		SDLppRenderer& operator=(const SDLppRenderer&) = delete; // oprateur d'assignation par copie
 		SDLppRenderer& operator=(SDLppRenderer&&) noexcept; // oprateur d'assignation par copie
 
 	private:
+		void CountDrawCall(SDL_Texture* texture);
+
+		RendererStats m_frameStats;
+		RendererStats m_lastFrameStats;
 		SDL_Renderer* m_renderer;
+		SDL_Texture* m_lastTexture;
 };
\ No newline at end of file
@@ -16,6 +16,7 @@ class A4ENGINE_API SDLppTexture
 
 		const std::string& GetFilepath() const;
 		SDL_Texture* GetHandle() const;
+		std::size_t GetMemoryUsage() const; //< estimated from the size, 4 bytes per pixel (the texture lives on the GPU)
 		SDL_Rect GetRect() const;
 
 		SDLppTexture& operator=(const SDLppTexture&) = delete; // oprateur d'assignation par copie
@@ -2,17 +2,16 @@
 
 #include <A4Engine/Export.hpp>
 #include <A4Engine/Shape.h>
-#include <memory>
 
 class A4ENGINE_API SegmentShape : public Shape
 {
 public:
 	SegmentShape(cpVect a, cpVect b, float radius);
-	~SegmentShape();
+	~SegmentShape() = default;
 
-	cpShape* CreateShape(cpBody* body) override;
+	cpShape* CreateShape(cpBody* body, void* memory) const override;
 
-	float GetMoment(float mass) override;
+	float GetMoment(float mass) const override;
 private:
 
 	cpVect m_a;
@@ -3,18 +3,25 @@
 #include <A4Engine/Export.hpp>
 #include <chipmunk/chipmunk.h>
 
+// Description of a collision shape, RigidBodyComponent::AddShape builds the Chipmunk shape from it
+// (the description isn't needed afterwards, it can live on the stack or be shared by many bodies)
 class A4ENGINE_API Shape
 {
 public:
-	Shape();
-	~Shape() = default;
+	Shape() = default;
+	virtual ~Shape() = default;
 
-	cpShape* GetShape();
+	//memory is a PhysicsSystem pool slot, big enough for any Chipmunk shape
+	virtual cpShape* CreateShape(cpBody* body, void* memory) const = 0;
 
-	virtual cpShape* CreateShape(cpBody* body);
+	unsigned int GetCollisionLayer() const;
+	virtual float GetMoment(float mass) const = 0;
 
-	virtual float GetMoment(float mass);
+	//BodyLayer = use the layer of the RigidBodyComponent the shape is added to
+	void SetCollisionLayer(unsigned int layer);
 
-protected:
-	cpShape* m_shape;
-};
\ No newline at end of file
+	static constexpr unsigned int BodyLayer = 0xFFFFFFFF;
+
+private:
+	unsigned int m_collisionLayer = BodyLayer;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <A4Engine/Export.hpp>
+#include "dr_wav.h"
+#include <cstdint>
+#include <vector>
+
+// Mixes voices on the CPU into an interleaved stereo buffer instead of going through an OpenAL device
+// The result is either discarded (null sink) or written to a .wav file, which makes audio testable on headless machines
+class A4ENGINE_API SoftwareMixer
+{
+public:
+	//wavOutputPath = nullptr for a null sink
+	SoftwareMixer(std::size_t voiceCount, unsigned int sampleRate, const char* wavOutputPath = nullptr);
+	SoftwareMixer(const SoftwareMixer&) = delete;
+	SoftwareMixer(SoftwareMixer&&) = delete;
+	~SoftwareMixer();
+
+	//Last mixed block, before (float) and after (int16) conversion
+	const float* GetMixBuffer() const;
+	const std::int16_t* GetOutput() const;
+	std::size_t GetOutputFrameCount() const;
+
+	unsigned int GetSampleRate() const;
+	std::size_t GetVoiceCount() const;
+
+	std::size_t GetVoiceOffset(std::size_t voiceIndex) const; //< in source frames
+	bool IsVoicePlaying(std::size_t voiceIndex) const;
+
+	void Mix(std::size_t frameCount);
+
+	//Only mono and stereo samples are supported, they must outlive the voice
+	void PlayVoice(std::size_t voiceIndex, const std::int16_t* samples, std::size_t frameCount, unsigned int channelCount, unsigned int sampleRate, bool looping);
+	void SetVoiceGain(std::size_t voiceIndex, float gain);
+	void SetVoiceOffset(std::size_t voiceIndex, std::size_t frameOffset);
+	void SetVoicePan(std::size_t voiceIndex, float pan); //< -1 = left, 0 = center, 1 = right
+	void SetVoicePitch(std::size_t voiceIndex, float pitch);
+	void StopVoice(std::size_t voiceIndex);
+
+	SoftwareMixer& operator=(const SoftwareMixer&) = delete;
+	SoftwareMixer& operator=(SoftwareMixer&&) = delete;
+
+	static constexpr std::size_t BlockFrameCount = 1024; //< Mix() works by blocks of this size
+
+private:
+	struct Voice
+	{
+		const std::int16_t* samples;
+		std::size_t frameCount;
+		std::uint64_t position; //< 32.32 fixed point, in source frames
+		std::uint64_t step;     //< same, source frames per output frame
+		unsigned int channelCount;
+		unsigned int sampleRate;
+		float gain;
+		float pan;
+		float pitch;
+		bool looping;
+		bool playing;
+	};
+
+	void MixBlock(std::size_t frameCount);
+	void MixVoice(Voice& voice, float* output, std::size_t frameCount);
+	void UpdateStep(Voice& voice);
+
+	std::vector<Voice> m_voices;
+	std::vector<float> m_mixBuffer;
+	std::vector<std::int16_t> m_output;
+	std::size_t m_outputFrameCount;
+	unsigned int m_sampleRate;
+
+	drwav m_wav;
+	bool m_writeToFile;
+};
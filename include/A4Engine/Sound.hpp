@@ -1,5 +1,6 @@
 #pragma once
 #include <A4Engine/Export.hpp>
+#include <A4Engine/SoundSystem.h>
 #include <AL/al.h>
 #include "AL/alc.h"
 #include "dr_wav.h"
@@ -8,30 +9,42 @@
 #include <memory>
 #include <string>
 
+// Sound data only (an OpenAL buffer, or the samples themselves with the software backend),
+// voices playing it are taken from the SoundSystem pool so the same sound can overlap with itself
 class A4ENGINE_API Sound
 {
 public:
 	Sound() = delete;
-	Sound(const Sound&) = default;
+	Sound(const Sound&) = delete;
 	Sound(Sound&& sound) noexcept;
 	~Sound();
 	//Only .wav files
 	static Sound LoadFromFile(const char* soundPath);
+	//Whole .wav file already in memory (e.g. read from an archive), only needed during the call
+	static Sound LoadFromMemory(const void* data, std::size_t size, const char* name = "<memory>");
 
-	void Play();
+	ALuint GetBuffer() const;
+	unsigned int GetChannelCount() const;
+	float GetDuration() const; //< in seconds
+	std::size_t GetFrameCount() const;
+	std::size_t GetMemoryUsage() const; //< bytes, in the OpenAL buffer or in the samples
+	unsigned int GetSampleRate() const;
+	const std::int16_t* GetSamples() const; //< nullptr unless the software backend is used
+
+	VoiceHandle Play(int priority = 0, bool looping = false) const;
 
 	Sound& operator=(const Sound&) = delete;
-	Sound& operator=(Sound&&) = default;
+	Sound& operator=(Sound&& sound) noexcept;
 
 	bool IsValid() const;
 private:
-	//Only .wav files
-	Sound(const char* path);
+	Sound(const void* data, std::size_t size, const char* name);
 
 	bool invalid;
 
 	ALuint m_buffer;
-	ALuint m_source;
-
+	unsigned int m_channelCount;
+	unsigned int m_sampleRate;
+	std::size_t m_frameCount;
 	std::vector<std::int16_t> m_samples;
-};
\ No newline at end of file
+};
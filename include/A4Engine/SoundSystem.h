@@ -2,18 +2,104 @@
 #include "AL/al.h"
 #include "AL/alc.h"
 #include <A4Engine/Export.hpp>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
+class Sound;
+class SoftwareMixer;
+
+enum class AudioBackend
+{
+	OpenAL,  //< default output device
+	Software //< SoftwareMixer, to a null sink or a .wav file (tests, benchmarks, headless machines)
+};
+
+// Identifies a playing voice, becomes stale once the voice is stopped or stolen by another sound
+struct VoiceHandle
+{
+	std::uint32_t index = InvalidIndex;
+	std::uint32_t generation = 0;
+
+	bool IsValid() const { return index != InvalidIndex; }
+
+	static constexpr std::uint32_t InvalidIndex = 0xFFFFFFFF;
+};
+
 class A4ENGINE_API SoundSystem
 {
 public:
 	SoundSystem();
+	//wavOutputPath is only used by the software backend, nullptr = null sink
+	SoundSystem(AudioBackend backend, const char* wavOutputPath = nullptr);
+	SoundSystem(const SoundSystem&) = delete;
+	SoundSystem(SoundSystem&&) = delete;
 	~SoundSystem();
 
+	AudioBackend GetBackend() const;
 	const ALCdevice& GetDevice();
 	const ALCcontext& GetContext();
+	SoftwareMixer* GetMixer();
+	unsigned int GetOutputSampleRate() const; //< sounds are resampled to this rate when loaded
+	std::size_t GetFreeVoiceCount() const;
+	std::size_t GetVoiceCount() const;
+	float GetVoiceOffset(VoiceHandle voice) const; //< in seconds
+
+	bool IsPlaying(VoiceHandle voice) const;
+
+	//Takes a free voice, or steals the lowest priority (then oldest) one if they are all busy
+	//Returns an invalid handle if every voice plays something more important
+	VoiceHandle Play(const Sound& sound, int priority = 0, bool looping = false);
+
+	void SetVoiceGain(VoiceHandle voice, float gain);
+	void SetVoiceOffset(VoiceHandle voice, float offset);
+	//Position relative to the listener, voices start at the listener position (no panning)
+	void SetVoicePosition(VoiceHandle voice, float x, float y);
+
+	void Stop(VoiceHandle voice);
+	//Stops every voice playing this sound, so it can be deleted
+	void StopSound(const Sound& sound);
+
+	//Gives finished voices back to the pool, to call once per frame
+	void Update();
+
+	SoundSystem& operator=(const SoundSystem&) = delete;
+	SoundSystem& operator=(SoundSystem&&) = delete;
+
+	static bool HasInstance();
+	static SoundSystem& Instance();
+
+	static constexpr std::size_t MaxVoiceCount = 256;
+	static constexpr std::size_t StreamSourceCount = 8; //< sources left outside the pool for StreamingSound
+	static constexpr unsigned int SoftwareSampleRate = 44100;
 
 private:
+	struct Voice
+	{
+		ALuint source;
+		ALuint buffer;
+		const std::int16_t* samples; //< software backend
+		unsigned int sampleRate;
+		int priority;
+		std::uint64_t startOrder;
+		std::uint32_t generation;
+		bool active;
+	};
+
+	const Voice* GetVoice(VoiceHandle voice) const;
+	void InitVoices(std::size_t voiceCount);
+	bool IsVoiceStopped(std::uint32_t voiceIndex) const;
+	void ReleaseVoice(std::uint32_t voiceIndex);
+	void StopVoice(std::uint32_t voiceIndex);
+
+	AudioBackend m_backend;
 	ALCdevice* device;
 	ALCcontext* context;
+	std::unique_ptr<SoftwareMixer> m_mixer;
+
+	std::vector<Voice> m_voices;
+	std::vector<std::uint32_t> m_freeVoices;
+	std::uint64_t m_playCounter;
+
+	static SoundSystem* s_instance;
 };
@@ -0,0 +1,61 @@
+#pragma once
+#include <A4Engine/AudioResampler.hpp>
+#include <A4Engine/Export.hpp>
+#include <AL/al.h>
+#include "dr_wav.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Plays long .wav files (music) without decoding them entirely:
+// a background thread decodes small chunks into a ring of OpenAL buffers queued on the source (OpenAL backend only)
+class A4ENGINE_API StreamingSound
+{
+public:
+	//Only .wav files
+	StreamingSound(const char* path);
+	StreamingSound() = delete;
+	StreamingSound(const StreamingSound&) = delete;
+	StreamingSound(StreamingSound&&) = delete; //< the decoder keeps pointers to itself, it can't be moved
+	~StreamingSound();
+
+	bool IsPlaying() const;
+	bool IsValid() const;
+
+	void Play();
+	void SetLooping(bool looping);
+	void Stop();
+
+	StreamingSound& operator=(const StreamingSound&) = delete;
+	StreamingSound& operator=(StreamingSound&&) = delete;
+
+	static constexpr std::size_t BufferCount = 4;
+	static constexpr std::size_t ChunkFrameCount = 8192; //< ~190ms at 44.1kHz, 32KB per stereo chunk
+
+private:
+	bool FillBuffer(ALuint buffer);
+	void StreamThread();
+
+	bool invalid;
+
+	drwav m_wav;
+	ALenum m_format;
+	ALuint m_source;
+	unsigned int m_channelCount; //< played, the file may have more (they are downmixed to stereo)
+	unsigned int m_sampleRate; //< played, the output rate
+	std::optional<AudioResampler> m_resampler; //< when the file rate isn't the output rate
+	std::array<ALuint, BufferCount> m_buffers;
+
+	std::atomic<bool> m_looping;
+	std::atomic<bool> m_running;
+	std::thread m_thread;
+
+	// Only touched by the streaming thread
+	std::vector<std::int16_t> m_chunk;
+	std::vector<std::int16_t> m_downmixedChunk;
+	std::vector<std::int16_t> m_resampledChunk;
+	AudioResampler::StreamState m_resamplerState;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <A4Engine/Export.hpp>
+#include <entt/core/type_info.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class JobCounter;
+class JobSystem;
+class SystemScheduler;
+
+// Returned by SystemScheduler::AddSystem to declare what the system touches.
+// Any type can be declared (components, but also SoundSystem, SDLppRenderer, ...), the type is only used as a key
+class A4ENGINE_API SystemDeclaration
+{
+	friend SystemScheduler;
+
+	public:
+		SystemDeclaration(const SystemDeclaration&) = default;
+		SystemDeclaration(SystemDeclaration&&) = default;
+		~SystemDeclaration() = default;
+
+		//For systems calling SDL (rendering, windows, events)
+		SystemDeclaration& MainThreadOnly();
+
+		template<typename... T> SystemDeclaration& Reads();
+		template<typename... T> SystemDeclaration& Writes();
+
+		SystemDeclaration& operator=(const SystemDeclaration&) = delete;
+		SystemDeclaration& operator=(SystemDeclaration&&) = delete;
+
+	private:
+		SystemDeclaration(SystemScheduler& scheduler, std::size_t systemIndex);
+
+		void AddAccess(entt::id_type resource, std::string_view resourceName, bool write);
+
+		SystemScheduler& m_scheduler;
+		std::size_t m_systemIndex;
+};
+
+// Runs a set of systems once per frame. Two systems conflict if one of them writes what the other one reads or writes,
+// conflicting systems run in the order they were added and the others run in parallel on the JobSystem (if there is one).
+// The dependency graph is rebuilt when a system is added, the frame following that runs serially on the calling thread
+// so that entt creates the pools of every viewed component before systems run concurrently
+class A4ENGINE_API SystemScheduler
+{
+	friend SystemDeclaration;
+
+	public:
+		using System = std::function<void(float /*deltaTime*/)>;
+
+		SystemScheduler();
+		SystemScheduler(const SystemScheduler&) = delete;
+		SystemScheduler(SystemScheduler&&) = delete;
+		~SystemScheduler() = default;
+
+		//The name is interned in the Profiler for the system zones, create it before adding systems to see them
+		SystemDeclaration AddSystem(std::string name, System system);
+
+		//Levels, dependencies (and the resource causing them), threads and timings of the last Run
+		std::string GetScheduleDump() const;
+		std::size_t GetSystemCount() const;
+		const std::string& GetSystemName(std::size_t systemIndex) const; //< systems are indexed in the order they were added
+		double GetSystemTime(std::size_t systemIndex) const; //< in milliseconds, during the last Run
+
+		//Must be called from the main thread (which runs MainThreadOnly systems), returns once every system is done
+		void Run(float deltaTime);
+
+		SystemScheduler& operator=(const SystemScheduler&) = delete;
+		SystemScheduler& operator=(SystemScheduler&&) = delete;
+
+	private:
+		struct Access
+		{
+			entt::id_type resource;
+			std::string_view resourceName;
+			bool write;
+		};
+
+		struct Dependency
+		{
+			std::size_t systemIndex;
+			std::string_view resourceName; //< first conflicting resource
+		};
+
+		struct SystemData
+		{
+			std::string name;
+			const char* zoneName = nullptr; //< interned once, nullptr without profiler
+			System function;
+			std::vector<Access> accesses;
+			std::vector<Dependency> dependencies; //< earlier systems which must be done before this one starts
+			std::vector<std::size_t> dependents;
+			unsigned int level = 0; //< longest dependency chain leading to this system
+			bool mainThreadOnly = false;
+
+			// Last run
+			double startTime = 0.0; //< in milliseconds since the beginning of Run
+			double endTime = 0.0;
+			unsigned int threadIndex = 0; //< see JobSystem::GetCurrentThreadIndex
+		};
+
+		void BuildGraph();
+		void Launch(std::size_t systemIndex, JobSystem& jobSystem, JobCounter& frameCounter);
+		void RunSystem(std::size_t systemIndex);
+
+		std::vector<SystemData> m_systems;
+		std::unique_ptr<std::atomic<std::size_t>[]> m_remainingDependencies;
+		std::chrono::steady_clock::time_point m_frameStart;
+		std::uint64_t m_frameIndex;
+		double m_frameDuration; //< in milliseconds
+		float m_deltaTime;
+		unsigned int m_levelCount;
+		bool m_graphDirty;
+		bool m_lastRunParallel;
+};
+
+#include <A4Engine/SystemScheduler.inl>
@@ -0,0 +1,13 @@
+template<typename... T>
+SystemDeclaration& SystemDeclaration::Reads()
+{
+	(AddAccess(entt::type_hash<T>::value(), entt::type_name<T>::value(), false), ...);
+	return *this;
+}
+
+template<typename... T>
+SystemDeclaration& SystemDeclaration::Writes()
+{
+	(AddAccess(entt::type_hash<T>::value(), entt::type_name<T>::value(), true), ...);
+	return *this;
+}
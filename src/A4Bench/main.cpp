@@ -0,0 +1,406 @@
+#include <A4Engine/AllocationHooks.hpp>
+#include <A4Engine/AllocationTracker.hpp>
+#include <A4Engine/BoxShape.hpp>
+#include <A4Engine/CircleShape.hpp>
+#include <A4Engine/JobSystem.hpp>
+#include <A4Engine/Matrix3.h>
+#include <A4Engine/PhysicsSnapshot.hpp>
+#include <A4Engine/PhysicsSystem.h>
+#include <A4Engine/RigidBodyComponent.h>
+#include <A4Engine/SDLpp.hpp>
+#include <A4Engine/SDLppRenderer.hpp>
+#include <A4Engine/SDLppSurface.hpp>
+#include <A4Engine/SDLppTexture.hpp>
+#include <A4Engine/SDLppWindow.hpp>
+#include <A4Engine/SegmentShape.hpp>
+#include <A4Engine/Sound.hpp>
+#include <A4Engine/SoundSystem.h>
+#include <A4Engine/SoftwareMixer.hpp>
+#include <A4Engine/Sprite.hpp>
+#include <A4Engine/Transform.hpp>
+#include <A4Engine/VelocityComponent.hpp>
+#include <A4Engine/VelocitySystem.hpp>
+#include <fmt/core.h>
+#include <entt/entt.hpp>
+#include <chrono>
+#include <vector>
+
+// Allocations made by a loop in its steady state should be 0, they're only seen with the allocationtracking option
+void PrintSteadyStateAllocations(std::size_t allocationCount)
+{
+#ifdef A4ENGINE_ALLOCATION_TRACKING
+	if (allocationCount > 0)
+		fmt::print("  {} allocations in steady state!\n", allocationCount);
+	else
+		fmt::print("  no allocation in steady state\n");
+#else
+	(void) allocationCount;
+#endif
+}
+
+// Throughput of the software mixer: how many voices can be mixed per millisecond of CPU time
+void BenchmarkMixer(const char* soundPath)
+{
+	SoundSystem soundSystem(AudioBackend::Software);
+	SoftwareMixer& mixer = *soundSystem.GetMixer();
+
+	Sound sound = Sound::LoadFromFile(soundPath);
+	if (!sound.IsValid())
+		return;
+
+	constexpr std::size_t BlockCount = 200;
+
+	std::vector<VoiceHandle> voices;
+	voices.reserve(SoundSystem::MaxVoiceCount);
+
+	fmt::print("software mixer ({} frames per block, {} Hz)\n", SoftwareMixer::BlockFrameCount, mixer.GetSampleRate());
+	for (std::size_t voiceCount : { 1, 16, 64, 256 })
+	{
+		for (VoiceHandle voice : voices)
+			soundSystem.Stop(voice);
+
+		voices.clear();
+		for (std::size_t i = 0; i < voiceCount; ++i)
+			voices.push_back(sound.Play(0, true));
+
+		auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < BlockCount; ++i)
+			mixer.Mix(SoftwareMixer::BlockFrameCount);
+		auto end = std::chrono::steady_clock::now();
+
+		double elapsedMs = std::chrono::duration<double, std::milli>(end - start).count();
+		double blockMs = elapsedMs / BlockCount;
+		fmt::print("{:>4} voices: {:.4f}ms per block, {:.1f} voice-blocks per ms\n", voiceCount, blockMs, voiceCount / blockMs);
+	}
+}
+
+// Solver cost of a pile of boxes falling into a container, bodies are added straight to the space (no entities)
+// so only Chipmunk is measured
+void BenchmarkPhysicsPile(std::size_t bodyCount, const PhysicsSettings& settings)
+{
+	constexpr float BoxSize = 10.f;
+	constexpr std::size_t ColumnCount = 100;
+	constexpr float TimeStep = 1.f / 60.f;
+	constexpr std::size_t SettleStepCount = 60; //< let the pile form before measuring, so contacts are there
+	constexpr std::size_t MeasuredStepCount = 120;
+
+	entt::registry registry;
+	PhysicsSystem physicsSystem(registry, settings);
+
+	// Container: floor and two walls
+	float width = ColumnCount * BoxSize * 1.1f;
+	cpBody* staticBody = cpSpaceGetStaticBody(physicsSystem.GetSpace());
+	std::vector<cpShape*> shapes;
+	shapes.push_back(physicsSystem.CreateShape(staticBody, SegmentShape(cpv(0.f, 0.f), cpv(width, 0.f), 1.f)));
+	shapes.push_back(physicsSystem.CreateShape(staticBody, SegmentShape(cpv(0.f, 0.f), cpv(0.f, -100'000.f), 1.f)));
+	shapes.push_back(physicsSystem.CreateShape(staticBody, SegmentShape(cpv(width, 0.f), cpv(width, -100'000.f), 1.f)));
+
+	BoxShape box(BoxSize, BoxSize);
+
+	std::vector<cpBody*> bodies;
+	bodies.reserve(bodyCount);
+	for (std::size_t i = 0; i < bodyCount; ++i)
+	{
+		float x = (i % ColumnCount + 0.5f) * BoxSize * 1.1f;
+		float y = -(i / ColumnCount + 0.5f) * BoxSize * 1.1f;
+
+		cpBody* body = physicsSystem.CreateBody(1.f, box.GetMoment(1.f));
+		cpBodySetPosition(body, cpv(x, y));
+		bodies.push_back(body);
+
+		cpShape* shape = physicsSystem.CreateShape(body, box);
+		cpShapeSetFriction(shape, 0.7f);
+		shapes.push_back(shape);
+	}
+
+	for (std::size_t i = 0; i < SettleStepCount; ++i)
+		physicsSystem.FixedUpdate(TimeStep);
+
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < MeasuredStepCount; ++i)
+		physicsSystem.FixedUpdate(TimeStep);
+	auto end = std::chrono::steady_clock::now();
+
+	double stepMs = std::chrono::duration<double, std::milli>(end - start).count() / MeasuredStepCount;
+	const PhysicsStats& stats = physicsSystem.GetStats();
+	const char* broadphaseName = (physicsSystem.GetBroadphase() == PhysicsBroadphase::BBTree) ? "bbtree" : "hash";
+	fmt::print("{:>6} bodies, {:<6}, {} thread(s), {} iterations: {:.3f}ms per step ({} pairs, {} contacts)\n", bodyCount, broadphaseName, physicsSystem.GetThreadCount(), physicsSystem.GetIterations(), stepMs, stats.collidingPairCount, stats.contactCount);
+
+	// Vertical rays through the pile, as AI line of sight checks would do
+	constexpr std::size_t RayCount = 10'000;
+	std::vector<RaycastQuery> rays(RayCount);
+	std::vector<RaycastHit> hits(RayCount);
+	for (std::size_t i = 0; i < RayCount; ++i)
+	{
+		float x = width * (i + 0.5f) / RayCount;
+		rays[i].from = Vector2f(x, -100'000.f);
+		rays[i].to = Vector2f(x, 10.f);
+	}
+
+	auto MeasureRaycasts = [&]
+	{
+		auto raycastStart = std::chrono::steady_clock::now();
+		physicsSystem.Raycast(rays.data(), rays.size(), hits.data());
+		auto raycastEnd = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double, std::micro>(raycastEnd - raycastStart).count() / RayCount;
+	};
+
+	// Serial, then split over the workers (only the BB tree broadphase can be queried from several threads)
+	double serialRayUs = MeasureRaycasts();
+	if (physicsSystem.AreQueriesThreadSafe())
+	{
+		JobSystem jobSystem;
+		double parallelRayUs = MeasureRaycasts();
+		fmt::print("{:>6} bodies, {:<6}: {:.3f}us per raycast serial, {:.3f}us with {} workers + main thread\n", bodyCount, broadphaseName, serialRayUs, parallelRayUs, jobSystem.GetWorkerCount());
+	}
+	else
+		fmt::print("{:>6} bodies, {:<6}: {:.3f}us per raycast\n", bodyCount, broadphaseName, serialRayUs);
+
+	for (cpShape* shape : shapes)
+		physicsSystem.DestroyShape(shape);
+
+	for (cpBody* body : bodies)
+		physicsSystem.DestroyBody(body);
+}
+
+// Spawning and destroying waves of projectile entities, once the pools and the registry have grown
+// to the size of a wave nothing should allocate anymore
+void BenchmarkProjectiles(std::size_t projectileCount)
+{
+	constexpr std::size_t WaveCount = 50;
+
+	entt::registry registry;
+	PhysicsSystem physicsSystem(registry);
+
+	// Projectiles never hit each other, the layer filters drop those pairs before contact generation
+	unsigned int projectileLayer = physicsSystem.AddCollisionLayer("Projectile");
+	physicsSystem.SetLayersCollide(projectileLayer, projectileLayer, false);
+
+	CircleShape bullet(2.f);
+	bullet.SetCollisionLayer(projectileLayer);
+	std::vector<entt::entity> projectiles(projectileCount);
+
+	auto SpawnWave = [&]
+	{
+		for (std::size_t i = 0; i < projectileCount; ++i)
+		{
+			projectiles[i] = registry.create();
+
+			RigidBodyComponent& rigidBody = registry.emplace<RigidBodyComponent>(projectiles[i], physicsSystem, 0.1f);
+			rigidBody.AddShape(bullet);
+			rigidBody.SetPosition(cpv(i * 5.f, 0.f));
+		}
+
+		physicsSystem.FixedUpdate(1.f / 60.f);
+
+		for (entt::entity projectile : projectiles)
+			registry.destroy(projectile);
+	};
+
+	SpawnWave(); //< warm-up, grows everything
+	std::size_t capacity = physicsSystem.GetPoolCapacity();
+
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < WaveCount; ++i)
+		SpawnWave();
+	auto end = std::chrono::steady_clock::now();
+
+	double waveMs = std::chrono::duration<double, std::milli>(end - start).count() / WaveCount;
+	fmt::print("{:>6} projectiles: {:.3f}ms per spawn/step/destroy wave, pools {}\n", projectileCount, waveMs, (physicsSystem.GetPoolCapacity() == capacity) ? "stable" : "grew");
+}
+
+// Rollback cost on a settling pile of entities: saving every step into the ring, restoring a frame from half a second ago,
+// and whether stepping again from it gives the same hashes
+void BenchmarkSnapshots(std::size_t bodyCount)
+{
+	constexpr float BoxSize = 10.f;
+	constexpr std::size_t ColumnCount = 50;
+	constexpr float TimeStep = 1.f / 60.f;
+	constexpr std::size_t FrameCount = 60;
+
+	entt::registry registry;
+	PhysicsSystem physicsSystem(registry);
+
+	float width = ColumnCount * BoxSize * 1.1f;
+	cpShape* floor = physicsSystem.CreateShape(cpSpaceGetStaticBody(physicsSystem.GetSpace()), SegmentShape(cpv(0.f, 0.f), cpv(width, 0.f), 1.f));
+
+	BoxShape box(BoxSize, BoxSize);
+	for (std::size_t i = 0; i < bodyCount; ++i)
+	{
+		entt::entity entity = registry.create();
+
+		RigidBodyComponent& rigidBody = registry.emplace<RigidBodyComponent>(entity, physicsSystem, 1.f);
+		cpShapeSetFriction(rigidBody.AddShape(box), 0.7f);
+		rigidBody.SetPosition(cpv((i % ColumnCount + 0.5f) * BoxSize * 1.1f, -(i / ColumnCount + 0.5f) * BoxSize * 1.1f));
+	}
+
+	PhysicsSnapshotRing ring(FrameCount, bodyCount, bodyCount * 4);
+	physicsSystem.SaveSnapshot(ring.Push());
+
+	double saveUs = 0.0;
+	for (std::size_t i = 1; i < FrameCount; ++i)
+	{
+		physicsSystem.FixedUpdate(TimeStep);
+
+		auto start = std::chrono::steady_clock::now();
+		physicsSystem.SaveSnapshot(ring.Push());
+		auto end = std::chrono::steady_clock::now();
+
+		saveUs += std::chrono::duration<double, std::micro>(end - start).count();
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::size_t restoredContactCount = physicsSystem.RestoreSnapshot(*ring.Find(physicsSystem.GetStepIndex() - FrameCount / 2));
+	auto end = std::chrono::steady_clock::now();
+	double restoreUs = std::chrono::duration<double, std::micro>(end - start).count();
+
+	// Restores the newest frame when done
+	PhysicsDeterminismReport report = physicsSystem.CheckDeterminism(ring);
+
+	fmt::print("{:>6} bodies: {:.1f}us per save, {:.1f}us per restore ({} contacts warm started), {}KB for {} frames\n", bodyCount, saveUs / (FrameCount - 1), restoreUs, restoredContactCount, ring.GetMemoryUsage() / 1024, FrameCount);
+	if (report.deterministic)
+		fmt::print("{:>6} bodies: deterministic over {} steps\n", bodyCount, report.checkedStepCount);
+	else
+		fmt::print("{:>6} bodies: diverged at step {} after {} steps\n", bodyCount, report.firstMismatchStep, report.checkedStepCount);
+
+	registry.clear();
+	physicsSystem.DestroyShape(floor);
+}
+
+// VelocitySystem over many entities, serial (no JobSystem) then split over the workers
+void BenchmarkVelocitySystem(std::size_t entityCount)
+{
+	constexpr std::size_t UpdateCount = 100;
+
+	entt::registry registry;
+	for (std::size_t i = 0; i < entityCount; ++i)
+	{
+		entt::entity entity = registry.create();
+		registry.emplace<Transform>(entity);
+
+		VelocityComponent& velocity = registry.emplace<VelocityComponent>(entity);
+		velocity.linearVel = Vector2f(1.f, 2.f);
+		velocity.angularVel = 3.f;
+	}
+
+	VelocitySystem velocitySystem(registry);
+
+	auto Measure = [&]
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < UpdateCount; ++i)
+			velocitySystem.Update(1.f / 60.f);
+		auto end = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double, std::milli>(end - start).count() / UpdateCount;
+	};
+
+	double serialMs;
+	std::size_t steadyStateAllocationCount;
+	{
+		NoAllocationScope steadyState;
+		serialMs = Measure();
+		steadyStateAllocationCount = steadyState.GetAllocationCount();
+	}
+
+	JobSystem jobSystem;
+	double parallelMs = Measure();
+
+	fmt::print("{:>7} entities: {:.3f}ms serial, {:.3f}ms with {} workers + main thread\n", entityCount, serialMs, parallelMs, jobSystem.GetWorkerCount());
+	PrintSteadyStateAllocations(steadyStateAllocationCount);
+}
+
+// Submission cost of many sprites through SDLppRenderer (hidden window, software renderer so the GPU doesn't hide the CPU cost)
+// sprites alternate between two textures every batchSize sprites, which shows up as texture switches
+void BenchmarkSpriteRendering(std::size_t spriteCount, std::size_t batchSize)
+{
+	constexpr std::size_t FrameCount = 50;
+
+	SDLpp sdl;
+	SDLppWindow window("A4Bench", 1280, 720, SDL_WINDOW_HIDDEN);
+	SDLppRenderer renderer(window, "software");
+
+	std::vector<Sprite> sprites;
+	for (Uint8 color : { 64, 192 })
+	{
+		SDLppSurface surface(32, 32);
+		surface.FillRect(SDL_Rect{ 0, 0, 32, 32 }, color, color, color, 255);
+		sprites.emplace_back(std::make_shared<SDLppTexture>(SDLppTexture::LoadFromSurface(renderer, surface)));
+	}
+
+	auto DrawFrame = [&]
+	{
+		for (std::size_t i = 0; i < spriteCount; ++i)
+		{
+			Matrix3 transform(Vector2f(static_cast<float>(i % 1280), static_cast<float>((i / 1280) % 720)), 0.f, Vector2f(1.f, 1.f));
+			sprites[(i / batchSize) % sprites.size()].Draw(renderer, transform);
+		}
+	};
+
+	// First frame out of the measure, it may grow internal buffers
+	renderer.Clear();
+	DrawFrame();
+	renderer.Present();
+
+	double drawMs = 0.0;
+	std::size_t steadyStateAllocationCount;
+	{
+		NoAllocationScope steadyState;
+		for (std::size_t frame = 0; frame < FrameCount; ++frame)
+		{
+			renderer.Clear();
+
+			auto start = std::chrono::steady_clock::now();
+			DrawFrame();
+			drawMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			renderer.Present();
+		}
+		steadyStateAllocationCount = steadyState.GetAllocationCount();
+	}
+
+	const RendererStats& stats = renderer.GetLastFrameStats();
+	fmt::print("{:>6} sprites, batches of {:>4}: {:.3f}ms to submit, {} draw calls, {} vertices, {} texture switches, clear {:.3f}ms, present {:.3f}ms\n",
+		spriteCount, batchSize, drawMs / FrameCount, stats.drawCallCount, stats.vertexCount, stats.textureSwitchCount, stats.clearTime, stats.presentTime);
+	PrintSteadyStateAllocations(steadyStateAllocationCount);
+}
+
+int main()
+{
+	BenchmarkMixer("assets/Error.wav");
+
+	fmt::print("physics pile (10px boxes, 1/60s steps)\n");
+	for (std::size_t bodyCount : { 1'000, 5'000, 20'000 })
+	{
+		for (PhysicsBroadphase broadphase : { PhysicsBroadphase::BBTree, PhysicsBroadphase::AutoSpatialHash })
+		{
+			for (unsigned int threadCount : { 1, 2 })
+			{
+				PhysicsSettings settings;
+				settings.broadphase = broadphase;
+				settings.threadCount = threadCount;
+
+				BenchmarkPhysicsPile(bodyCount, settings);
+			}
+		}
+	}
+
+	fmt::print("projectile waves\n");
+	for (std::size_t projectileCount : { 1'000, 5'000 })
+		BenchmarkProjectiles(projectileCount);
+
+	fmt::print("velocity system\n");
+	for (std::size_t entityCount : { 10'000, 200'000 })
+		BenchmarkVelocitySystem(entityCount);
+
+	fmt::print("physics snapshots\n");
+	for (std::size_t bodyCount : { 500, 2'000 })
+		BenchmarkSnapshots(bodyCount);
+
+	fmt::print("sprite rendering\n");
+	for (std::size_t batchSize : { 1, 1'000 })
+		BenchmarkSpriteRendering(10'000, batchSize);
+
+	return 0;
+}
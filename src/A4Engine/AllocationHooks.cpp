@@ -0,0 +1,2 @@
+// Global operator new/delete of the engine module, only replaced with the allocationtracking option
+#include <A4Engine/AllocationHooks.hpp>
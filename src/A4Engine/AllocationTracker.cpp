@@ -0,0 +1,438 @@
+#include <A4Engine/AllocationTracker.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+	// Everything here may be used before main and from any thread: only zero-initialized storage, nothing which allocates
+	constexpr std::size_t CallSiteCapacity = 4096; //< power of two
+	constexpr std::size_t MaxProbeCount = 32;
+	constexpr std::size_t MaxTagDepth = 64;
+	constexpr std::size_t TagCapacity = 256; //< power of two
+
+	constexpr std::size_t DefaultAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+	constexpr const char* OtherCallSitesTag = "(other call sites)";
+	constexpr const char* OtherTagsTag = "(other tags)";
+	constexpr const char* UntaggedTag = "(untagged)";
+
+	// Stored right before the memory given to the user
+	struct AllocationHeader
+	{
+		std::size_t size;
+		std::uint32_t offset; //< from the malloc'ed block to the user memory
+		std::uint32_t generation; //< of the tracker which counted it, 0 if none did
+	};
+
+	constexpr std::size_t HeaderSize = (sizeof(AllocationHeader) + DefaultAlignment - 1) / DefaultAlignment * DefaultAlignment;
+
+	struct CallSiteEntry
+	{
+		std::atomic<const void*> key;
+		std::atomic<const char*> tag;
+		std::atomic<std::size_t> allocationCount;
+		std::atomic<std::size_t> allocatedBytes;
+	};
+
+	struct TagEntry
+	{
+		std::atomic<const void*> key;
+		std::atomic<std::size_t> allocationCount;
+		std::atomic<std::size_t> allocatedBytes;
+
+		// Only used by the tracker, from the thread calling EndFrame
+		std::size_t frameStartAllocationCount;
+		std::size_t frameStartAllocatedBytes;
+		std::size_t lastFrameAllocationCount;
+		std::size_t lastFrameAllocatedBytes;
+	};
+
+	std::array<CallSiteEntry, CallSiteCapacity> s_callSites;
+	std::array<TagEntry, TagCapacity> s_tags;
+	CallSiteEntry s_otherCallSites;
+	TagEntry s_otherTags;
+
+	std::atomic<bool> s_enabled{ false };
+	std::atomic<std::uint32_t> s_generation{ 0 };
+	std::atomic<std::size_t> s_allocatedBytes{ 0 };
+	std::atomic<std::size_t> s_allocationCount{ 0 };
+	std::atomic<std::size_t> s_liveBytes{ 0 };
+	std::atomic<std::size_t> s_peakBytes{ 0 };
+
+	thread_local const char* s_tagStack[MaxTagDepth];
+	thread_local std::size_t s_tagDepth = 0;
+
+	thread_local std::size_t s_forbiddenAllocationCount = 0;
+	thread_local std::size_t s_noAllocationDepth = 0;
+	thread_local ForbiddenAllocationPolicy s_forbiddenAllocationPolicy = ForbiddenAllocationPolicy::Count;
+
+	// Open addressing keyed by pointer, a slot is claimed once and never released (until the next tracker)
+	template<typename Entry, std::size_t Capacity>
+	Entry* FindEntry(std::array<Entry, Capacity>& entries, const void* key)
+	{
+		std::uintptr_t hash = (reinterpret_cast<std::uintptr_t>(key) >> 4) * static_cast<std::uintptr_t>(0x9E3779B97F4A7C15ull);
+		for (std::size_t probe = 0; probe < MaxProbeCount; ++probe)
+		{
+			Entry& entry = entries[(hash + probe) & (Capacity - 1)];
+
+			const void* entryKey = entry.key.load(std::memory_order_acquire);
+			if (entryKey == nullptr && entry.key.compare_exchange_strong(entryKey, key, std::memory_order_acq_rel))
+				return &entry;
+
+			if (entryKey == key)
+				return &entry;
+		}
+
+		return nullptr;
+	}
+
+	const char* GetCurrentTag()
+	{
+		if (s_tagDepth == 0)
+			return UntaggedTag;
+
+		return s_tagStack[std::min(s_tagDepth, MaxTagDepth) - 1];
+	}
+
+	void Track(std::size_t size, const void* callSite)
+	{
+		s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+		s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+		std::size_t liveBytes = s_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+		std::size_t peakBytes = s_peakBytes.load(std::memory_order_relaxed);
+		while (liveBytes > peakBytes && !s_peakBytes.compare_exchange_weak(peakBytes, liveBytes, std::memory_order_relaxed));
+
+		const char* tag = GetCurrentTag();
+
+		TagEntry* tagEntry = FindEntry(s_tags, tag);
+		if (!tagEntry)
+			tagEntry = &s_otherTags;
+
+		tagEntry->allocationCount.fetch_add(1, std::memory_order_relaxed);
+		tagEntry->allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+		CallSiteEntry* callSiteEntry = FindEntry(s_callSites, callSite);
+		if (!callSiteEntry)
+			callSiteEntry = &s_otherCallSites;
+
+		// The first allocation seen at this call site names it
+		const char* noTag = nullptr;
+		callSiteEntry->tag.compare_exchange_strong(noTag, tag, std::memory_order_relaxed);
+		callSiteEntry->allocationCount.fetch_add(1, std::memory_order_relaxed);
+		callSiteEntry->allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	void ResetTag(TagEntry& entry)
+	{
+		entry.key.store(nullptr, std::memory_order_relaxed);
+		entry.allocationCount.store(0, std::memory_order_relaxed);
+		entry.allocatedBytes.store(0, std::memory_order_relaxed);
+		entry.frameStartAllocationCount = 0;
+		entry.frameStartAllocatedBytes = 0;
+		entry.lastFrameAllocationCount = 0;
+		entry.lastFrameAllocatedBytes = 0;
+	}
+
+	void ResetCallSite(CallSiteEntry& entry)
+	{
+		entry.key.store(nullptr, std::memory_order_relaxed);
+		entry.tag.store(nullptr, std::memory_order_relaxed);
+		entry.allocationCount.store(0, std::memory_order_relaxed);
+		entry.allocatedBytes.store(0, std::memory_order_relaxed);
+	}
+}
+
+AllocationTracker::AllocationTracker() :
+m_frameStartAllocatedBytes(0),
+m_frameStartAllocationCount(0),
+m_lastFrameAllocatedBytes(0),
+m_lastFrameAllocationCount(0)
+{
+	if (s_instance != nullptr)
+		throw std::runtime_error("only one AllocationTracker can be created");
+
+	// Allocations made before (or by a previous tracker) aren't counted
+	for (TagEntry& entry : s_tags)
+		ResetTag(entry);
+
+	for (CallSiteEntry& entry : s_callSites)
+		ResetCallSite(entry);
+
+	ResetTag(s_otherTags);
+	s_otherTags.key.store(OtherTagsTag, std::memory_order_relaxed);
+	ResetCallSite(s_otherCallSites);
+	s_otherCallSites.tag.store(OtherCallSitesTag, std::memory_order_relaxed);
+
+	s_allocatedBytes.store(0, std::memory_order_relaxed);
+	s_allocationCount.store(0, std::memory_order_relaxed);
+	s_liveBytes.store(0, std::memory_order_relaxed);
+	s_peakBytes.store(0, std::memory_order_relaxed);
+
+	s_generation.fetch_add(1, std::memory_order_relaxed);
+
+	s_instance = this;
+	s_enabled.store(true, std::memory_order_release);
+}
+
+AllocationTracker::~AllocationTracker()
+{
+	s_enabled.store(false, std::memory_order_release);
+	s_instance = nullptr;
+}
+
+void AllocationTracker::EndFrame()
+{
+	std::size_t allocatedBytes = s_allocatedBytes.load(std::memory_order_relaxed);
+	std::size_t allocationCount = s_allocationCount.load(std::memory_order_relaxed);
+
+	m_lastFrameAllocatedBytes = allocatedBytes - m_frameStartAllocatedBytes;
+	m_lastFrameAllocationCount = allocationCount - m_frameStartAllocationCount;
+	m_frameStartAllocatedBytes = allocatedBytes;
+	m_frameStartAllocationCount = allocationCount;
+
+	auto EndTagFrame = [](TagEntry& entry)
+	{
+		std::size_t tagAllocatedBytes = entry.allocatedBytes.load(std::memory_order_relaxed);
+		std::size_t tagAllocationCount = entry.allocationCount.load(std::memory_order_relaxed);
+
+		entry.lastFrameAllocatedBytes = tagAllocatedBytes - entry.frameStartAllocatedBytes;
+		entry.lastFrameAllocationCount = tagAllocationCount - entry.frameStartAllocationCount;
+		entry.frameStartAllocatedBytes = tagAllocatedBytes;
+		entry.frameStartAllocationCount = tagAllocationCount;
+	};
+
+	for (TagEntry& entry : s_tags)
+	{
+		if (entry.key.load(std::memory_order_acquire) != nullptr)
+			EndTagFrame(entry);
+	}
+	EndTagFrame(s_otherTags);
+}
+
+std::vector<AllocationCallSite> AllocationTracker::GetCallSites(std::size_t maxCount) const
+{
+	std::vector<AllocationCallSite> callSites;
+	auto AddCallSite = [&](const CallSiteEntry& entry)
+	{
+		std::size_t allocationCount = entry.allocationCount.load(std::memory_order_relaxed);
+		if (allocationCount > 0)
+		{
+			const char* tag = entry.tag.load(std::memory_order_relaxed);
+			callSites.push_back({ entry.key.load(std::memory_order_relaxed), (tag) ? tag : UntaggedTag, allocationCount, entry.allocatedBytes.load(std::memory_order_relaxed) });
+		}
+	};
+
+	for (const CallSiteEntry& entry : s_callSites)
+		AddCallSite(entry);
+	AddCallSite(s_otherCallSites);
+
+	auto end = callSites.begin() + std::min(maxCount, callSites.size());
+	std::partial_sort(callSites.begin(), end, callSites.end(), [](const AllocationCallSite& lhs, const AllocationCallSite& rhs)
+	{
+		return lhs.allocationCount > rhs.allocationCount;
+	});
+	callSites.erase(end, callSites.end());
+
+	return callSites;
+}
+
+std::size_t AllocationTracker::GetLastFrameAllocatedBytes() const
+{
+	return m_lastFrameAllocatedBytes;
+}
+
+std::size_t AllocationTracker::GetLastFrameAllocationCount() const
+{
+	return m_lastFrameAllocationCount;
+}
+
+std::size_t AllocationTracker::GetLiveBytes() const
+{
+	return s_liveBytes.load(std::memory_order_relaxed);
+}
+
+std::size_t AllocationTracker::GetPeakBytes() const
+{
+	return s_peakBytes.load(std::memory_order_relaxed);
+}
+
+std::string AllocationTracker::GetReport(std::size_t callSiteCount) const
+{
+	std::string report;
+	auto out = std::back_inserter(report);
+
+	fmt::format_to(out, "{} allocations ({:.1f} KiB), {} during the last frame ({:.1f} KiB)\n", GetTotalAllocationCount(), s_allocatedBytes.load(std::memory_order_relaxed) / 1024.0, m_lastFrameAllocationCount, m_lastFrameAllocatedBytes / 1024.0);
+	fmt::format_to(out, "live {:.1f} KiB, peak {:.1f} KiB\n", GetLiveBytes() / 1024.0, GetPeakBytes() / 1024.0);
+
+	report += "tags:\n";
+	for (const AllocationTagStats& tag : GetTagStats())
+		fmt::format_to(out, "  {:<32} {:>8} allocations {:>12.1f} KiB, last frame {:>6} allocations {:>10.1f} KiB\n", tag.tag, tag.allocationCount, tag.allocatedBytes / 1024.0, tag.lastFrameAllocationCount, tag.lastFrameAllocatedBytes / 1024.0);
+
+	report += "call sites:\n";
+	for (const AllocationCallSite& callSite : GetCallSites(callSiteCount))
+		fmt::format_to(out, "  {:>18} {:<32} {:>8} allocations {:>12.1f} KiB\n", callSite.address, callSite.tag, callSite.allocationCount, callSite.allocatedBytes / 1024.0);
+
+	return report;
+}
+
+std::vector<AllocationTagStats> AllocationTracker::GetTagStats() const
+{
+	// The same literal may have a different address in each module, tags are merged by name
+	std::vector<AllocationTagStats> tags;
+	auto AddTag = [&](const TagEntry& entry)
+	{
+		const char* tag = static_cast<const char*>(entry.key.load(std::memory_order_acquire));
+		std::size_t allocationCount = entry.allocationCount.load(std::memory_order_relaxed);
+		if (!tag || allocationCount == 0)
+			return;
+
+		auto it = std::find_if(tags.begin(), tags.end(), [&](const AllocationTagStats& stats) { return std::strcmp(stats.tag, tag) == 0; });
+		if (it == tags.end())
+			it = tags.insert(tags.end(), AllocationTagStats{ tag, 0, 0, 0, 0 });
+
+		it->allocationCount += allocationCount;
+		it->allocatedBytes += entry.allocatedBytes.load(std::memory_order_relaxed);
+		it->lastFrameAllocationCount += entry.lastFrameAllocationCount;
+		it->lastFrameAllocatedBytes += entry.lastFrameAllocatedBytes;
+	};
+
+	for (const TagEntry& entry : s_tags)
+		AddTag(entry);
+	AddTag(s_otherTags);
+
+	std::sort(tags.begin(), tags.end(), [](const AllocationTagStats& lhs, const AllocationTagStats& rhs)
+	{
+		return lhs.allocatedBytes > rhs.allocatedBytes;
+	});
+
+	return tags;
+}
+
+std::size_t AllocationTracker::GetTotalAllocationCount() const
+{
+	return s_allocationCount.load(std::memory_order_relaxed);
+}
+
+void AllocationTracker::ResetPeak()
+{
+	s_peakBytes.store(s_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void* AllocationTracker::Allocate(std::size_t size, std::size_t alignment, const void* callSite)
+{
+	alignment = std::max(alignment, DefaultAlignment);
+	assert(alignment < (std::size_t(1) << 31));
+
+	// malloc already aligns on DefaultAlignment, over-aligned memory needs room to be shifted
+	std::size_t padding = (alignment > DefaultAlignment) ? alignment : 0;
+	if (size > SIZE_MAX - HeaderSize - padding)
+		return nullptr;
+
+	std::byte* block = static_cast<std::byte*>(std::malloc(HeaderSize + padding + size));
+	if (!block)
+		return nullptr;
+
+	std::uintptr_t address = reinterpret_cast<std::uintptr_t>(block + HeaderSize);
+	std::byte* memory = block + HeaderSize + ((alignment - address % alignment) % alignment);
+
+	AllocationHeader* header = reinterpret_cast<AllocationHeader*>(memory - HeaderSize);
+	header->size = size;
+	header->offset = static_cast<std::uint32_t>(memory - block);
+	header->generation = 0;
+
+	if (s_noAllocationDepth > 0)
+	{
+		s_forbiddenAllocationCount++;
+		if (s_forbiddenAllocationPolicy == ForbiddenAllocationPolicy::Abort)
+		{
+			// No fmt here, it could allocate
+			std::fprintf(stderr, "forbidden allocation of %zu bytes from %p (%s)\n", size, callSite, GetCurrentTag());
+			std::abort();
+		}
+	}
+
+	if (s_enabled.load(std::memory_order_relaxed))
+	{
+		header->generation = s_generation.load(std::memory_order_relaxed);
+		Track(size, callSite);
+	}
+
+	return memory;
+}
+
+void AllocationTracker::Deallocate(void* memory)
+{
+	if (!memory)
+		return;
+
+	std::byte* userMemory = static_cast<std::byte*>(memory);
+	AllocationHeader* header = reinterpret_cast<AllocationHeader*>(userMemory - HeaderSize);
+
+	// Memory allocated before the tracker existed isn't part of its live bytes
+	if (header->generation != 0 && header->generation == s_generation.load(std::memory_order_relaxed) && s_enabled.load(std::memory_order_relaxed))
+		s_liveBytes.fetch_sub(header->size, std::memory_order_relaxed);
+
+	std::free(userMemory - header->offset);
+}
+
+AllocationTracker& AllocationTracker::Instance()
+{
+	if (s_instance == nullptr)
+		throw std::runtime_error("AllocationTracker hasn't been instantied");
+
+	return *s_instance;
+}
+
+bool AllocationTracker::IsEnabled()
+{
+	return s_instance != nullptr;
+}
+
+void AllocationTracker::PopTag()
+{
+	assert(s_tagDepth > 0);
+	s_tagDepth--;
+}
+
+void AllocationTracker::PushTag(const char* tag)
+{
+	if (!tag)
+		tag = GetCurrentTag();
+
+	// Tags deeper than the stack are merged into the last one that fit
+	if (s_tagDepth < MaxTagDepth)
+		s_tagStack[s_tagDepth] = tag;
+
+	s_tagDepth++;
+}
+
+AllocationTracker* AllocationTracker::s_instance = nullptr;
+
+NoAllocationScope::NoAllocationScope(ForbiddenAllocationPolicy policy) :
+m_previousPolicy(s_forbiddenAllocationPolicy),
+m_startCount(s_forbiddenAllocationCount)
+{
+	s_forbiddenAllocationPolicy = policy;
+	s_noAllocationDepth++;
+}
+
+NoAllocationScope::~NoAllocationScope()
+{
+	s_noAllocationDepth--;
+	s_forbiddenAllocationPolicy = m_previousPolicy;
+}
+
+std::size_t NoAllocationScope::GetAllocationCount() const
+{
+	return s_forbiddenAllocationCount - m_startCount;
+}
@@ -1,4 +1,5 @@
 #include <A4Engine/AnimationSystem.hpp>
+#include <A4Engine/JobSystem.hpp>
 #include <A4Engine/SpritesheetComponent.hpp>
 #include <entt/entt.hpp>
 
@@ -9,10 +10,11 @@ m_registry(registry)
 
 void AnimationSystem::Update(float deltaTime)
 {
+	// Each SpritesheetComponent drives its own sprite, entities can be updated in parallel
 	auto view = m_registry.view<SpritesheetComponent>();
-	for (entt::entity entity : view)
+	JobSystem::ParallelForEach(view, [&](entt::entity entity)
 	{
 		SpritesheetComponent& entitySpritesheet = view.get<SpritesheetComponent>(entity);
 		entitySpritesheet.Update(deltaTime);
-	}
+	});
 }
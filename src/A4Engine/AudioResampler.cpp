@@ -0,0 +1,223 @@
+#include "A4Engine/AudioResampler.hpp"
+#include <A4Engine/Math.hpp>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define A4_RESAMPLER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	float DotProduct(const float* a, const float* b, std::size_t count)
+	{
+		std::size_t i = 0;
+		float result = 0.f;
+#if defined(A4_RESAMPLER_SSE2)
+		__m128 sum0 = _mm_setzero_ps();
+		__m128 sum1 = _mm_setzero_ps();
+		std::size_t vectorizedCount = count - count % 8;
+		for (; i < vectorizedCount; i += 8)
+		{
+			sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(&a[i]), _mm_loadu_ps(&b[i])));
+			sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(&a[i + 4]), _mm_loadu_ps(&b[i + 4])));
+		}
+
+		// Horizontal sum
+		__m128 sum = _mm_add_ps(sum0, sum1);
+		sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+		sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+		result = _mm_cvtss_f32(sum);
+#endif
+		for (; i < count; ++i)
+			result += a[i] * b[i];
+
+		return result;
+	}
+
+	float Sinc(float x)
+	{
+		if (std::abs(x) < 1e-6f)
+			return 1.f;
+
+		return std::sin(Pi * x) / (Pi * x);
+	}
+}
+
+AudioResampler::AudioResampler(unsigned int inputRate, unsigned int outputRate)
+{
+	if (inputRate == 0 || outputRate == 0)
+		throw std::runtime_error("AudioResampler sample rates must not be zero");
+
+	// outputRate / inputRate = up / down, each output frame n reads the input around n * down / up
+	std::uint64_t divisor = std::gcd(inputRate, outputRate);
+	m_upFactor = outputRate / divisor;
+	m_downFactor = inputRate / divisor;
+
+	// One filter per distinct fractional position, unless there are too many of them (rates which don't share much)
+	m_phaseCount = static_cast<std::size_t>(std::min<std::uint64_t>(m_upFactor, MaxPhaseCount));
+
+	// When downsampling, the cutoff has to move down to the new Nyquist frequency
+	float cutoff = std::min(1.f, static_cast<float>(outputRate) / inputRate);
+
+	constexpr float halfWidth = TapCount / 2.f;
+
+	m_coefficients.resize(m_phaseCount * TapCount);
+	for (std::size_t phase = 0; phase < m_phaseCount; ++phase)
+	{
+		float frac = static_cast<float>(phase) / m_phaseCount;
+		float* taps = &m_coefficients[phase * TapCount];
+
+		float sum = 0.f;
+		for (std::size_t k = 0; k < TapCount; ++k)
+		{
+			// Distance between this tap and the exact position of the output frame
+			float t = static_cast<float>(k) - (halfWidth - 1.f) - frac;
+
+			// Blackman window
+			float window = 0.42f + 0.5f * std::cos(Pi * t / halfWidth) + 0.08f * std::cos(2.f * Pi * t / halfWidth);
+			taps[k] = cutoff * Sinc(cutoff * t) * window;
+			sum += taps[k];
+		}
+
+		// Normalize so every phase keeps the same gain
+		for (std::size_t k = 0; k < TapCount; ++k)
+			taps[k] /= sum;
+	}
+}
+
+std::size_t AudioResampler::GetOutputFrameCount(std::size_t inputFrameCount) const
+{
+	return static_cast<std::size_t>(inputFrameCount * m_upFactor / m_downFactor);
+}
+
+std::vector<std::int16_t> AudioResampler::Process(const std::int16_t* samples, std::size_t frameCount, unsigned int channelCount) const
+{
+	std::size_t outputFrameCount = GetOutputFrameCount(frameCount);
+	std::vector<std::int16_t> output(outputFrameCount * channelCount);
+
+	// Work on one channel at a time, converted to float and padded with silence so the taps never go out of bounds
+	constexpr std::size_t padding = TapCount;
+	std::vector<float> channel(frameCount + padding * 2, 0.f);
+
+	for (unsigned int c = 0; c < channelCount; ++c)
+	{
+		for (std::size_t i = 0; i < frameCount; ++i)
+			channel[padding + i] = samples[i * channelCount + c];
+
+		for (std::size_t n = 0; n < outputFrameCount; ++n)
+		{
+			std::uint64_t position = n * m_downFactor;
+			std::size_t index = static_cast<std::size_t>(position / m_upFactor);
+			std::size_t phase = static_cast<std::size_t>((position % m_upFactor) * m_phaseCount / m_upFactor);
+
+			const float* input = &channel[padding + index - (TapCount / 2 - 1)];
+			float value = DotProduct(input, &m_coefficients[phase * TapCount], TapCount);
+
+			output[n * channelCount + c] = static_cast<std::int16_t>(std::lrint(std::clamp(value, -32768.f, 32767.f)));
+		}
+	}
+
+	return output;
+}
+
+void AudioResampler::ProcessChunk(const std::int16_t* samples, std::size_t frameCount, unsigned int channelCount, StreamState& state, std::vector<std::int16_t>& output) const
+{
+	// The stream starts with the same silence Process pads with
+	if (state.channels.size() != channelCount)
+	{
+		state.channels.assign(channelCount, std::vector<float>(TapCount / 2 - 1, 0.f));
+		state.position = 0;
+	}
+
+	for (unsigned int c = 0; c < channelCount; ++c)
+	{
+		std::vector<float>& channel = state.channels[c];
+		for (std::size_t i = 0; i < frameCount; ++i)
+			channel.push_back(samples[i * channelCount + c]);
+	}
+
+	std::size_t bufferedFrameCount = state.channels.front().size();
+	for (;;)
+	{
+		std::size_t index = static_cast<std::size_t>(state.position / m_upFactor);
+		if (index + TapCount > bufferedFrameCount)
+			break; //< the taps of this frame reach the next chunk
+
+		std::size_t phase = static_cast<std::size_t>((state.position % m_upFactor) * m_phaseCount / m_upFactor);
+		for (unsigned int c = 0; c < channelCount; ++c)
+		{
+			float value = DotProduct(&state.channels[c][index], &m_coefficients[phase * TapCount], TapCount);
+			output.push_back(static_cast<std::int16_t>(std::lrint(std::clamp(value, -32768.f, 32767.f))));
+		}
+
+		state.position += m_downFactor;
+	}
+
+	// Input frames before the taps of the next output frame won't be read anymore
+	std::size_t consumedFrameCount = static_cast<std::size_t>(state.position / m_upFactor);
+	for (std::vector<float>& channel : state.channels)
+		channel.erase(channel.begin(), channel.begin() + consumedFrameCount);
+
+	state.position -= static_cast<std::uint64_t>(consumedFrameCount) * m_upFactor;
+}
+
+void AudioResampler::Flush(unsigned int channelCount, StreamState& state, std::vector<std::int16_t>& output) const
+{
+	if (state.channels.empty())
+		return;
+
+	// Silence after the end, as Process pads with: just enough for the frames up to the last input frame
+	std::vector<std::int16_t> silence(TapCount / 2 * channelCount, 0);
+	ProcessChunk(silence.data(), TapCount / 2, channelCount, state, output);
+
+	state = {};
+}
+
+std::vector<std::int16_t> AudioResampler::ConvertChannels(const std::int16_t* samples, std::size_t frameCount, unsigned int inputChannelCount, unsigned int outputChannelCount)
+{
+	std::vector<std::int16_t> output(frameCount * outputChannelCount);
+
+	for (std::size_t i = 0; i < frameCount; ++i)
+	{
+		const std::int16_t* frame = &samples[i * inputChannelCount];
+		std::int16_t* outputFrame = &output[i * outputChannelCount];
+
+		if (outputChannelCount == 1)
+		{
+			// Average of every channel
+			int sum = 0;
+			for (unsigned int c = 0; c < inputChannelCount; ++c)
+				sum += frame[c];
+
+			outputFrame[0] = static_cast<std::int16_t>(sum / static_cast<int>(inputChannelCount));
+		}
+		else if (inputChannelCount == 1)
+		{
+			for (unsigned int c = 0; c < outputChannelCount; ++c)
+				outputFrame[c] = frame[0];
+		}
+		else
+		{
+			// Front left/right are kept, other channels (center, surround, ...) are mixed into both at half volume
+			float left = frame[0];
+			float right = frame[1];
+			for (unsigned int c = 2; c < inputChannelCount; ++c)
+			{
+				left += frame[c] * 0.5f;
+				right += frame[c] * 0.5f;
+			}
+
+			float scale = 1.f / (1.f + 0.5f * (inputChannelCount - 2));
+			outputFrame[0] = static_cast<std::int16_t>(left * scale);
+			outputFrame[1] = static_cast<std::int16_t>(right * scale);
+			for (unsigned int c = 2; c < outputChannelCount; ++c)
+				outputFrame[c] = 0;
+		}
+	}
+
+	return output;
+}
@@ -0,0 +1,64 @@
+#include <A4Engine/AudioSourceComponent.hpp>
+#include <A4Engine/Sound.hpp>
+
+AudioSourceComponent::AudioSourceComponent(std::shared_ptr<const Sound> sound, float maxDistance, bool looping) :
+m_sound(std::move(sound)),
+m_gain(1.f),
+m_maxDistance(maxDistance),
+m_playbackOffset(0.f),
+m_priority(0),
+m_looping(looping),
+m_playing(true)
+{
+}
+
+float AudioSourceComponent::GetGain() const
+{
+	return m_gain;
+}
+
+float AudioSourceComponent::GetMaxDistance() const
+{
+	return m_maxDistance;
+}
+
+float AudioSourceComponent::GetPlaybackOffset() const
+{
+	return m_playbackOffset;
+}
+
+bool AudioSourceComponent::IsVirtual() const
+{
+	return m_playing && !m_voice.IsValid();
+}
+
+bool AudioSourceComponent::IsPlaying() const
+{
+	return m_playing;
+}
+
+void AudioSourceComponent::Play()
+{
+	m_playing = true;
+	m_playbackOffset = 0.f;
+}
+
+void AudioSourceComponent::SetGain(float gain)
+{
+	m_gain = gain;
+}
+
+void AudioSourceComponent::SetMaxDistance(float maxDistance)
+{
+	m_maxDistance = maxDistance;
+}
+
+void AudioSourceComponent::SetPriority(int priority)
+{
+	m_priority = priority;
+}
+
+void AudioSourceComponent::Stop()
+{
+	m_playing = false; //< the AudioSystem releases the voice on its next update
+}
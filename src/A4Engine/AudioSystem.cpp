@@ -0,0 +1,118 @@
+#include <A4Engine/AudioSystem.hpp>
+#include <A4Engine/AudioListenerComponent.hpp>
+#include <A4Engine/AudioSourceComponent.hpp>
+#include <A4Engine/Sound.hpp>
+#include <A4Engine/SoundSystem.h>
+#include <A4Engine/Transform.hpp>
+#include <entt/entt.hpp>
+#include <cmath>
+
+AudioSystem::AudioSystem(entt::registry& registry) :
+m_registry(registry)
+{
+	m_registry.on_destroy<AudioSourceComponent>().connect<&AudioSystem::OnSourceDestroy>(this);
+}
+
+AudioSystem::~AudioSystem()
+{
+	m_registry.on_destroy<AudioSourceComponent>().disconnect<&AudioSystem::OnSourceDestroy>(this);
+}
+
+void AudioSystem::Update(float deltaTime)
+{
+	SoundSystem& soundSystem = SoundSystem::Instance();
+
+	Vector2f listenerPosition(0.f, 0.f);
+	auto listenerView = m_registry.view<Transform, AudioListenerComponent>();
+	for (entt::entity entity : listenerView)
+	{
+		listenerPosition = listenerView.get<Transform>(entity).GetGlobalPosition();
+		break;
+	}
+
+	auto view = m_registry.view<Transform, AudioSourceComponent>();
+	for (entt::entity entity : view)
+	{
+		AudioSourceComponent& source = view.get<AudioSourceComponent>(entity);
+		if (!source.m_playing || !source.m_sound)
+		{
+			if (source.m_voice.IsValid())
+			{
+				soundSystem.Stop(source.m_voice);
+				source.m_voice = {};
+			}
+
+			continue;
+		}
+
+		// Our voice may have been stolen by a more important sound
+		if (source.m_voice.IsValid() && !soundSystem.IsPlaying(source.m_voice))
+			source.m_voice = {};
+
+		// Virtual or not, the source keeps track of where it is in the sound, so it can resume at the right offset:
+		// read back from the voice while it plays (frame hitches don't make it drift), advanced by hand while virtual
+		float duration = source.m_sound->GetDuration();
+		if (source.m_voice.IsValid())
+			source.m_playbackOffset = soundSystem.GetVoiceOffset(source.m_voice);
+		else
+			source.m_playbackOffset += deltaTime;
+
+		if (source.m_playbackOffset >= duration)
+		{
+			if (!source.m_looping || duration <= 0.f)
+			{
+				source.m_playing = false;
+				if (source.m_voice.IsValid())
+				{
+					soundSystem.Stop(source.m_voice);
+					source.m_voice = {};
+				}
+
+				continue;
+			}
+
+			source.m_playbackOffset = std::fmod(source.m_playbackOffset, duration);
+		}
+
+		Vector2f offset = view.get<Transform>(entity).GetGlobalPosition() - listenerPosition;
+		float distanceSq = offset.x * offset.x + offset.y * offset.y;
+
+		// Linear attenuation up to the max distance, past it the source can't be heard at all
+		float gain = 0.f;
+		if (distanceSq < source.m_maxDistance * source.m_maxDistance)
+			gain = source.m_gain * (1.f - std::sqrt(distanceSq) / source.m_maxDistance);
+
+		if (source.m_voice.IsValid())
+		{
+			if (gain < AudibleGain)
+			{
+				// Virtualize: give the voice back, only the offset keeps advancing
+				soundSystem.Stop(source.m_voice);
+				source.m_voice = {};
+				continue;
+			}
+		}
+		else
+		{
+			// Virtual sources never steal voices, they wait for a free one
+			if (gain < AudibleGain * 2.f || soundSystem.GetFreeVoiceCount() == 0)
+				continue;
+
+			source.m_voice = soundSystem.Play(*source.m_sound, source.m_priority, source.m_looping);
+			if (!source.m_voice.IsValid())
+				continue;
+
+			soundSystem.SetVoiceOffset(source.m_voice, source.m_playbackOffset);
+		}
+
+		soundSystem.SetVoiceGain(source.m_voice, gain);
+		soundSystem.SetVoicePosition(source.m_voice, offset.x, offset.y);
+	}
+}
+
+void AudioSystem::OnSourceDestroy(entt::registry& registry, entt::entity entity)
+{
+	AudioSourceComponent& source = registry.get<AudioSourceComponent>(entity);
+	if (source.m_voice.IsValid() && SoundSystem::HasInstance())
+		SoundSystem::Instance().Stop(source.m_voice);
+}
@@ -6,13 +6,12 @@ BoxShape::BoxShape(float width, float height) :
 {
 }
 
-float BoxShape::GetMoment(float mass)
+float BoxShape::GetMoment(float mass) const
 {
 	return cpMomentForBox(mass, m_width, m_height);
 }
 
-cpShape* BoxShape::CreateShape(cpBody* body)
+cpShape* BoxShape::CreateShape(cpBody* body, void* memory) const
 {
-	m_shape = cpBoxShapeNew(body, m_width, m_height, 0);
-	return m_shape;
-}
\ No newline at end of file
+	return reinterpret_cast<cpShape*>(cpBoxShapeInit(static_cast<cpPolyShape*>(memory), body, m_width, m_height, 0));
+}
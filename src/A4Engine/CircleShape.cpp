@@ -5,12 +5,11 @@ CircleShape::CircleShape(float radius)
 	m_radius = radius;
 }
 
-cpShape* CircleShape::CreateShape(cpBody* body)
+cpShape* CircleShape::CreateShape(cpBody* body, void* memory) const
 {
-	m_shape = cpCircleShapeNew(body, m_radius, cpVect());
-	return m_shape;
+	return reinterpret_cast<cpShape*>(cpCircleShapeInit(static_cast<cpCircleShape*>(memory), body, m_radius, cpVect()));
 }
-float CircleShape::GetMoment(float mass)
+float CircleShape::GetMoment(float mass) const
 {
 	return cpMomentForCircle(mass, (double)m_radius * 2, (double)m_radius * 2, cpVect());
 }
@@ -0,0 +1,635 @@
+#include <A4Engine/CollisionGeometry.hpp>
+#include <A4Engine/FrameArena.hpp>
+#include <A4Engine/Model.hpp>
+#include <A4Engine/SDLppSurface.hpp>
+#include <chipmunk/chipmunk_structs.h>
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <fmt/std.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <memory_resource>
+#include <numeric>
+#include <unordered_map>
+
+// Version 1 files were built with polygons of up to 8 vertices, they're rebuilt with the current default
+constexpr unsigned int FileVersion = 2;
+
+static_assert(CollisionGeometry::DefaultMaxVertexCount <= CP_POLY_SHAPE_INLINE_ALLOC, "polygons past CP_POLY_SHAPE_INLINE_ALLOC vertices make Chipmunk allocate");
+
+namespace
+{
+	constexpr float Epsilon = 1e-4f;
+	constexpr float MinOutlineArea = 4.f; //< in pixels, smaller opaque spots are ignored
+
+	using Polygon = std::vector<Vector2f>;
+
+	// Builders run while loading, their intermediate buffers (everything but the polygons they return) come from the FrameArena
+
+	float Cross(const Vector2f& a, const Vector2f& b)
+	{
+		return a.x * b.y - a.y * b.x;
+	}
+
+	float Cross(const Vector2f& origin, const Vector2f& a, const Vector2f& b)
+	{
+		return Cross(a - origin, b - origin);
+	}
+
+	float Dot(const Vector2f& a, const Vector2f& b)
+	{
+		return a.x * b.x + a.y * b.y;
+	}
+
+	bool SamePoint(const Vector2f& a, const Vector2f& b)
+	{
+		return std::abs(a.x - b.x) <= Epsilon && std::abs(a.y - b.y) <= Epsilon;
+	}
+
+	// Tolerance is relative to the edges lengths so it works the same for model units and pixels
+	bool IsCollinear(const Vector2f& previous, const Vector2f& current, const Vector2f& next)
+	{
+		Vector2f a = current - previous;
+		Vector2f b = next - current;
+		float lengths = std::sqrt(Dot(a, a) * Dot(b, b));
+
+		return lengths <= Epsilon || std::abs(Cross(a, b)) <= Epsilon * lengths;
+	}
+
+	// Counter-clockwise = positive area, in a y-down space this appears clockwise on screen
+	float SignedArea(const Polygon& polygon)
+	{
+		float area = 0.f;
+		for (std::size_t i = 0; i < polygon.size(); ++i)
+			area += Cross(polygon[i], polygon[(i + 1) % polygon.size()]);
+
+		return area * 0.5f;
+	}
+
+	bool IsConvex(const Polygon& polygon)
+	{
+		std::size_t count = polygon.size();
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (Cross(polygon[(i + count - 1) % count], polygon[i], polygon[(i + 1) % count]) <= 0.f)
+				return false;
+		}
+
+		return true;
+	}
+
+	void RemoveCollinearVertices(Polygon& polygon)
+	{
+		bool removed;
+		do
+		{
+			removed = false;
+			for (std::size_t i = 0; i < polygon.size() && polygon.size() > 3; )
+			{
+				std::size_t count = polygon.size();
+				if (IsCollinear(polygon[(i + count - 1) % count], polygon[i], polygon[(i + 1) % count]))
+				{
+					polygon.erase(polygon.begin() + i);
+					removed = true;
+				}
+				else
+					++i;
+			}
+		}
+		while (removed && polygon.size() > 3);
+	}
+
+	void AddTriangle(std::vector<Polygon>& triangles, const Vector2f& a, const Vector2f& b, const Vector2f& c)
+	{
+		Vector2f ab = b - a;
+		Vector2f ac = c - a;
+		float area = Cross(ab, ac);
+		if (std::abs(area) <= Epsilon * std::sqrt(Dot(ab, ab) * Dot(ac, ac)))
+			return; //< degenerate
+
+		if (area > 0.f)
+			triangles.push_back({ a, b, c });
+		else
+			triangles.push_back({ a, c, b });
+	}
+
+	// Two counter-clockwise polygons sharing an edge see it in opposite directions
+	bool TryMerge(const Polygon& first, const Polygon& second, std::size_t maxVertexCount, Polygon& merged)
+	{
+		std::size_t firstCount = first.size();
+		std::size_t secondCount = second.size();
+		if (firstCount + secondCount - 2 > maxVertexCount + 2) //< merging can't remove more than the two shared vertices
+			return false;
+
+		for (std::size_t i = 0; i < firstCount; ++i)
+		{
+			const Vector2f& a0 = first[i];
+			const Vector2f& a1 = first[(i + 1) % firstCount];
+
+			for (std::size_t j = 0; j < secondCount; ++j)
+			{
+				if (!SamePoint(a0, second[(j + 1) % secondCount]) || !SamePoint(a1, second[j]))
+					continue;
+
+				// Walk first from the end of the shared edge back to its start, then the rest of second
+				merged.clear();
+				for (std::size_t k = 0; k < firstCount; ++k)
+					merged.push_back(first[(i + 1 + k) % firstCount]);
+
+				for (std::size_t k = 0; k < secondCount - 2; ++k)
+					merged.push_back(second[(j + 2 + k) % secondCount]);
+
+				RemoveCollinearVertices(merged);
+
+				return merged.size() <= maxVertexCount && IsConvex(merged);
+			}
+		}
+
+		return false;
+	}
+
+	// Greedy Hertel-Mehlhorn: keep merging neighbours while the result stays convex
+	std::vector<Polygon> MergeConvex(std::vector<Polygon> polygons, std::size_t maxVertexCount)
+	{
+		Polygon merged;
+
+		bool mergedAny;
+		do
+		{
+			mergedAny = false;
+			for (std::size_t i = 0; i < polygons.size(); ++i)
+			{
+				for (std::size_t j = i + 1; j < polygons.size(); )
+				{
+					if (TryMerge(polygons[i], polygons[j], maxVertexCount, merged))
+					{
+						std::swap(polygons[i], merged);
+						polygons[j] = std::move(polygons.back());
+						polygons.pop_back();
+						mergedAny = true;
+					}
+					else
+						++j;
+				}
+			}
+		}
+		while (mergedAny);
+
+		return polygons;
+	}
+
+	bool IsInsideTriangle(const Vector2f& point, const Vector2f& a, const Vector2f& b, const Vector2f& c)
+	{
+		// Points on the edges aren't inside, they can be shared by the outline
+		return Cross(a, b, point) > 0.f && Cross(b, c, point) > 0.f && Cross(c, a, point) > 0.f;
+	}
+
+	// Ear clipping, the polygon must be counter-clockwise
+	void Triangulate(const Polygon& polygon, std::vector<Polygon>& triangles)
+	{
+		std::pmr::vector<std::size_t> remaining(polygon.size(), FrameArena::GetResource());
+		std::iota(remaining.begin(), remaining.end(), std::size_t(0));
+
+		std::size_t i = 0;
+		std::size_t failCount = 0;
+		while (remaining.size() > 3)
+		{
+			std::size_t count = remaining.size();
+			const Vector2f& previous = polygon[remaining[(i + count - 1) % count]];
+			const Vector2f& current = polygon[remaining[i]];
+			const Vector2f& next = polygon[remaining[(i + 1) % count]];
+
+			bool isEar = Cross(previous, current, next) > 0.f;
+			for (std::size_t j = 0; isEar && j < count; ++j)
+			{
+				const Vector2f& point = polygon[remaining[j]];
+				if (SamePoint(point, previous) || SamePoint(point, current) || SamePoint(point, next))
+					continue;
+
+				if (IsInsideTriangle(point, previous, current, next))
+					isEar = false;
+			}
+
+			if (isEar)
+			{
+				AddTriangle(triangles, previous, current, next);
+				remaining.erase(remaining.begin() + i);
+				failCount = 0;
+			}
+			else if (++failCount > count)
+				return; //< no ear left, the simplified outline intersects itself; what's been clipped so far is kept
+
+			else
+				++i;
+
+			i %= remaining.size();
+		}
+
+		AddTriangle(triangles, polygon[remaining[0]], polygon[remaining[1]], polygon[remaining[2]]);
+	}
+
+	float SquaredDistanceToSegment(const Vector2f& point, const Vector2f& a, const Vector2f& b)
+	{
+		Vector2f ab = b - a;
+		Vector2f ap = point - a;
+
+		float lengthSq = Dot(ab, ab);
+		float t = (lengthSq > 0.f) ? std::clamp(Dot(ap, ab) / lengthSq, 0.f, 1.f) : 0.f;
+
+		Vector2f delta = ap - ab * t;
+		return Dot(delta, delta);
+	}
+
+	// Douglas-Peucker on a closed outline: it's split in two open lines at the vertex farthest from the first one
+	Polygon SimplifyOutline(const Polygon& outline, float tolerance)
+	{
+		std::size_t count = outline.size();
+		if (count <= 3)
+			return outline;
+
+		std::size_t farthest = 0;
+		float farthestDistanceSq = 0.f;
+		for (std::size_t i = 1; i < count; ++i)
+		{
+			Vector2f delta = outline[i] - outline[0];
+			float distanceSq = Dot(delta, delta);
+			if (distanceSq > farthestDistanceSq)
+			{
+				farthest = i;
+				farthestDistanceSq = distanceSq;
+			}
+		}
+
+		std::pmr::vector<bool> keep(count, false, FrameArena::GetResource());
+		keep[0] = true;
+		keep[farthest] = true;
+
+		// Ranges are [first, last] with last == count meaning vertex 0, iterative to not depend on the outline length
+		float toleranceSq = tolerance * tolerance;
+		std::pmr::vector<std::pair<std::size_t, std::size_t>> ranges({ { 0, farthest }, { farthest, count } }, FrameArena::GetResource());
+		while (!ranges.empty())
+		{
+			auto [first, last] = ranges.back();
+			ranges.pop_back();
+
+			if (last - first < 2)
+				continue;
+
+			const Vector2f& a = outline[first];
+			const Vector2f& b = outline[last % count];
+
+			std::size_t worst = first;
+			float worstDistanceSq = toleranceSq;
+			for (std::size_t i = first + 1; i < last; ++i)
+			{
+				float distanceSq = SquaredDistanceToSegment(outline[i], a, b);
+				if (distanceSq > worstDistanceSq)
+				{
+					worst = i;
+					worstDistanceSq = distanceSq;
+				}
+			}
+
+			if (worst != first)
+			{
+				keep[worst] = true;
+				ranges.emplace_back(first, worst);
+				ranges.emplace_back(worst, last);
+			}
+		}
+
+		Polygon simplified;
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (keep[i])
+				simplified.push_back(outline[i]);
+		}
+
+		return simplified;
+	}
+
+	// Follows the pixel edges between opaque and transparent pixels, each outline is returned counter-clockwise (holes are clockwise)
+	std::vector<Polygon> TraceOutlines(const std::pmr::vector<std::uint8_t>& mask, int width, int height)
+	{
+		auto IsOpaque = [&](int x, int y)
+		{
+			return x >= 0 && y >= 0 && x < width && y < height && mask[y * width + x] != 0;
+		};
+
+		auto CornerKey = [&](int x, int y)
+		{
+			return static_cast<std::uint64_t>(y) * static_cast<std::uint64_t>(width + 1) + static_cast<std::uint64_t>(x);
+		};
+
+		struct Edge
+		{
+			int fromX, fromY;
+			int toX, toY;
+		};
+
+		// Every opaque pixel contributes its sides facing a transparent pixel, oriented like the counter-clockwise pixel square
+		std::pmr::vector<Edge> edges(FrameArena::GetResource());
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				if (!IsOpaque(x, y))
+					continue;
+
+				if (!IsOpaque(x, y - 1))
+					edges.push_back({ x, y, x + 1, y });
+
+				if (!IsOpaque(x + 1, y))
+					edges.push_back({ x + 1, y, x + 1, y + 1 });
+
+				if (!IsOpaque(x, y + 1))
+					edges.push_back({ x + 1, y + 1, x, y + 1 });
+
+				if (!IsOpaque(x - 1, y))
+					edges.push_back({ x, y + 1, x, y });
+			}
+		}
+
+		std::pmr::unordered_multimap<std::uint64_t, std::size_t> edgesByStart(FrameArena::GetResource());
+		edgesByStart.reserve(edges.size());
+		for (std::size_t i = 0; i < edges.size(); ++i)
+			edgesByStart.emplace(CornerKey(edges[i].fromX, edges[i].fromY), i);
+
+		std::vector<Polygon> outlines;
+		std::pmr::vector<bool> visited(edges.size(), false, FrameArena::GetResource());
+		for (std::size_t start = 0; start < edges.size(); ++start)
+		{
+			if (visited[start])
+				continue;
+
+			Polygon& outline = outlines.emplace_back();
+
+			std::size_t current = start;
+			do
+			{
+				visited[current] = true;
+
+				const Edge& edge = edges[current];
+				outline.emplace_back(static_cast<float>(edge.fromX), static_cast<float>(edge.fromY));
+
+				// Two edges leave a corner touched by two diagonal pixels, turning left keeps those pixels in separate outlines
+				std::size_t next = edges.size();
+				auto range = edgesByStart.equal_range(CornerKey(edge.toX, edge.toY));
+				for (auto it = range.first; it != range.second; ++it)
+				{
+					std::size_t candidate = it->second;
+					if (visited[candidate] && candidate != start)
+						continue;
+
+					const Edge& candidateEdge = edges[candidate];
+					int turn = (edge.toX - edge.fromX) * (candidateEdge.toY - candidateEdge.fromY) - (edge.toY - edge.fromY) * (candidateEdge.toX - candidateEdge.fromX);
+					if (next == edges.size() || turn > 0)
+						next = candidate;
+				}
+
+				current = next;
+			}
+			while (current != start && current != edges.size());
+		}
+
+		return outlines;
+	}
+}
+
+CollisionGeometry::CollisionGeometry(std::vector<std::vector<Vector2f>> polygons) :
+m_polygons(std::move(polygons))
+{
+}
+
+std::vector<PolygonShape> CollisionGeometry::CreateShapes(const Vector2f& scale, const Vector2f& offset, float radius) const
+{
+	std::vector<PolygonShape> shapes;
+	shapes.reserve(m_polygons.size());
+
+	std::vector<Vector2f> vertices;
+	for (const std::vector<Vector2f>& polygon : m_polygons)
+	{
+		vertices.clear();
+		for (const Vector2f& vertex : polygon)
+			vertices.push_back(vertex * scale + offset);
+
+		shapes.emplace_back(vertices, radius);
+	}
+
+	return shapes;
+}
+
+const std::vector<std::vector<Vector2f>>& CollisionGeometry::GetPolygons() const
+{
+	return m_polygons;
+}
+
+std::size_t CollisionGeometry::GetMemoryUsage() const
+{
+	std::size_t memoryUsage = m_polygons.capacity() * sizeof(std::vector<Vector2f>);
+	for (const std::vector<Vector2f>& polygon : m_polygons)
+		memoryUsage += polygon.capacity() * sizeof(Vector2f);
+
+	return memoryUsage;
+}
+
+std::size_t CollisionGeometry::GetVertexCount() const
+{
+	std::size_t vertexCount = 0;
+	for (const std::vector<Vector2f>& polygon : m_polygons)
+		vertexCount += polygon.size();
+
+	return vertexCount;
+}
+
+bool CollisionGeometry::IsValid() const
+{
+	return !m_polygons.empty();
+}
+
+bool CollisionGeometry::SaveToFile(const std::filesystem::path& filepath) const
+{
+	std::ofstream outputFile(filepath);
+	if (!outputFile.is_open())
+	{
+		fmt::print(stderr, fg(fmt::color::red), "failed to open collision file {}\n", filepath);
+		return false;
+	}
+
+	outputFile << SaveToJSon().dump(4);
+	return true;
+}
+
+nlohmann::ordered_json CollisionGeometry::SaveToJSon() const
+{
+	nlohmann::ordered_json doc;
+	doc["version"] = FileVersion;
+
+	nlohmann::ordered_json& polygons = doc["polygons"];
+	polygons = nlohmann::ordered_json::array();
+	for (const std::vector<Vector2f>& polygon : m_polygons)
+	{
+		nlohmann::ordered_json& polygonDoc = polygons.emplace_back();
+		for (const Vector2f& vertex : polygon)
+		{
+			nlohmann::ordered_json& vertexDoc = polygonDoc.emplace_back();
+			vertexDoc["x"] = vertex.x;
+			vertexDoc["y"] = vertex.y;
+		}
+	}
+
+	return doc;
+}
+
+CollisionGeometry CollisionGeometry::BuildFromModel(const Model& model, std::size_t maxVertexCount)
+{
+	const std::vector<ModelVertex>& vertices = model.GetVertices();
+	const std::vector<int>& indices = model.GetIndices();
+
+	std::vector<Polygon> triangles;
+	if (!indices.empty())
+	{
+		for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			int a = indices[i];
+			int b = indices[i + 1];
+			int c = indices[i + 2];
+			if (a < 0 || b < 0 || c < 0 || std::max({ a, b, c }) >= static_cast<int>(vertices.size()))
+			{
+				fmt::print(stderr, fg(fmt::color::red), "model has an out of range index, triangle {} is ignored\n", i / 3);
+				continue;
+			}
+
+			AddTriangle(triangles, vertices[a].pos, vertices[b].pos, vertices[c].pos);
+		}
+	}
+	else
+	{
+		for (std::size_t i = 0; i + 2 < vertices.size(); i += 3)
+			AddTriangle(triangles, vertices[i].pos, vertices[i + 1].pos, vertices[i + 2].pos);
+	}
+
+	return CollisionGeometry(MergeConvex(std::move(triangles), std::max(maxVertexCount, std::size_t(3))));
+}
+
+CollisionGeometry CollisionGeometry::BuildFromSurface(const SDLppSurface& surface, Uint8 alphaThreshold, float tolerance, std::size_t maxVertexCount)
+{
+	if (!surface.IsValid())
+		return {};
+
+	// Working on a RGBA32 copy means we don't have to handle every pixel format to read the alpha
+	SDL_Surface* rgbaSurface = SDL_ConvertSurfaceFormat(surface.GetHandle(), SDL_PIXELFORMAT_RGBA32, 0);
+	if (!rgbaSurface)
+	{
+		fmt::print(stderr, fg(fmt::color::red), "failed to convert surface {}: {}\n", surface.GetFilepath(), SDL_GetError());
+		return {};
+	}
+
+	int width = rgbaSurface->w;
+	int height = rgbaSurface->h;
+
+	std::pmr::vector<std::uint8_t> mask(static_cast<std::size_t>(width) * static_cast<std::size_t>(height), FrameArena::GetResource());
+
+	SDL_LockSurface(rgbaSurface);
+	for (int y = 0; y < height; ++y)
+	{
+		const Uint8* row = static_cast<const Uint8*>(rgbaSurface->pixels) + y * rgbaSurface->pitch;
+		for (int x = 0; x < width; ++x)
+			mask[y * width + x] = (row[x * 4 + 3] >= alphaThreshold) ? 1 : 0;
+	}
+	SDL_UnlockSurface(rgbaSurface);
+	SDL_FreeSurface(rgbaSurface);
+
+	std::vector<Polygon> triangles;
+	for (Polygon& outline : TraceOutlines(mask, width, height))
+	{
+		RemoveCollinearVertices(outline); //< the traced outline has a vertex per pixel side
+
+		// Holes are clockwise and skipped (which fills them)
+		if (SignedArea(outline) < MinOutlineArea)
+			continue;
+
+		Polygon simplified = SimplifyOutline(outline, tolerance);
+		if (simplified.size() < 3 || SignedArea(simplified) <= 0.f)
+			continue;
+
+		Triangulate(simplified, triangles);
+	}
+
+	return CollisionGeometry(MergeConvex(std::move(triangles), std::max(maxVertexCount, std::size_t(3))));
+}
+
+CollisionGeometry CollisionGeometry::LoadFromFile(const std::filesystem::path& filepath)
+{
+	std::ifstream inputFile(filepath);
+	if (!inputFile.is_open())
+	{
+		fmt::print(stderr, fg(fmt::color::red), "failed to open collision file {}\n", filepath);
+		return {};
+	}
+
+	// Collision files are a cache, a broken one is reported and rebuilt instead of throwing
+	nlohmann::json doc = nlohmann::json::parse(inputFile, nullptr, false);
+	if (doc.is_discarded())
+	{
+		fmt::print(stderr, fg(fmt::color::red), "failed to parse collision file {}\n", filepath);
+		return {};
+	}
+
+	return LoadFromJSon(doc);
+}
+
+CollisionGeometry CollisionGeometry::LoadFromJSon(const nlohmann::json& doc)
+{
+	unsigned int version = doc.value("version", 0u);
+	if (version != FileVersion)
+	{
+		fmt::print(stderr, fg(fmt::color::red), "collision file has unsupported version {} (current version is {})\n", version, FileVersion);
+		return {};
+	}
+
+	// A malformed file gives an invalid geometry (rather than an exception), so a cached file is rebuilt
+	std::vector<std::vector<Vector2f>> polygons;
+	if (auto it = doc.find("polygons"); it != doc.end())
+	{
+		if (!it->is_array())
+		{
+			fmt::print(stderr, fg(fmt::color::red), "collision file polygons must be an array\n");
+			return {};
+		}
+
+		for (const nlohmann::json& polygonDoc : it.value())
+		{
+			if (!polygonDoc.is_array())
+			{
+				fmt::print(stderr, fg(fmt::color::red), "collision file polygon #{} must be an array of vertices\n", polygons.size());
+				return {};
+			}
+
+			std::vector<Vector2f>& polygon = polygons.emplace_back();
+			for (const nlohmann::json& vertexDoc : polygonDoc)
+			{
+				auto xIt = vertexDoc.find("x");
+				auto yIt = vertexDoc.find("y");
+				if (xIt == vertexDoc.end() || !xIt->is_number() || yIt == vertexDoc.end() || !yIt->is_number())
+				{
+					fmt::print(stderr, fg(fmt::color::red), "collision file polygon #{} has a vertex without numeric x and y\n", polygons.size() - 1);
+					return {};
+				}
+
+				polygon.emplace_back(xIt->get<float>(), yIt->get<float>());
+			}
+
+			if (polygon.size() < 3)
+			{
+				fmt::print(stderr, fg(fmt::color::red), "collision file polygon #{} has {} vertices (at least 3 are required)\n", polygons.size() - 1, polygon.size());
+				return {};
+			}
+		}
+	}
+
+	return CollisionGeometry(std::move(polygons));
+}
@@ -0,0 +1,89 @@
+#include <A4Engine/CollisionLayerTable.hpp>
+#include <cassert>
+#include <stdexcept>
+
+CollisionLayerTable::CollisionLayerTable()
+{
+	m_masks.fill(CP_ALL_CATEGORIES);
+	m_names.push_back("Default");
+}
+
+unsigned int CollisionLayerTable::AddLayer(std::string name)
+{
+	if (m_names.size() >= MaxLayerCount)
+		throw std::runtime_error("too many collision layers");
+
+	for (const std::string& layerName : m_names)
+	{
+		if (layerName == name)
+			throw std::runtime_error("collision layer " + name + " already exists");
+	}
+
+	m_names.push_back(std::move(name));
+	return static_cast<unsigned int>(m_names.size() - 1);
+}
+
+bool CollisionLayerTable::DoLayersCollide(unsigned int firstLayer, unsigned int secondLayer) const
+{
+	assert(firstLayer < m_names.size() && secondLayer < m_names.size());
+	return (m_masks[firstLayer] & (cpBitmask(1) << secondLayer)) != 0;
+}
+
+cpShapeFilter CollisionLayerTable::GetFilter(unsigned int layer) const
+{
+	assert(layer < m_names.size());
+	return cpShapeFilterNew(CP_NO_GROUP, cpBitmask(1) << layer, m_masks[layer]);
+}
+
+unsigned int CollisionLayerTable::GetLayer(const std::string& name) const
+{
+	for (std::size_t i = 0; i < m_names.size(); ++i)
+	{
+		if (m_names[i] == name)
+			return static_cast<unsigned int>(i);
+	}
+
+	throw std::runtime_error("unknown collision layer " + name);
+}
+
+std::size_t CollisionLayerTable::GetLayerCount() const
+{
+	return m_names.size();
+}
+
+const std::string& CollisionLayerTable::GetLayerName(unsigned int layer) const
+{
+	assert(layer < m_names.size());
+	return m_names[layer];
+}
+
+unsigned int CollisionLayerTable::GetFilterLayer(const cpShapeFilter& filter)
+{
+	// Our filters have exactly one category bit
+	cpBitmask categories = filter.categories;
+	if (categories == 0 || (categories & (categories - 1)) != 0)
+		return InvalidLayer;
+
+	unsigned int layer = 0;
+	while ((categories >>= 1) != 0)
+		layer++;
+
+	return layer;
+}
+
+void CollisionLayerTable::SetLayersCollide(unsigned int firstLayer, unsigned int secondLayer, bool collide)
+{
+	assert(firstLayer < m_names.size() && secondLayer < m_names.size());
+
+	// Chipmunk needs both shapes to accept each other, the matrix is kept symmetric
+	if (collide)
+	{
+		m_masks[firstLayer] |= cpBitmask(1) << secondLayer;
+		m_masks[secondLayer] |= cpBitmask(1) << firstLayer;
+	}
+	else
+	{
+		m_masks[firstLayer] &= ~(cpBitmask(1) << secondLayer);
+		m_masks[secondLayer] &= ~(cpBitmask(1) << firstLayer);
+	}
+}
@@ -0,0 +1,63 @@
+#include <A4Engine/FixedStepScheduler.hpp>
+#include <cassert>
+
+FixedStepScheduler::FixedStepScheduler(float timeStep, unsigned int maxStepCount) :
+m_accumulator(0.f),
+m_timeStep(timeStep),
+m_maxStepCount(maxStepCount)
+{
+	assert(timeStep > 0.f);
+}
+
+void FixedStepScheduler::AddSystem(System system)
+{
+	m_systems.push_back(std::move(system));
+}
+
+float FixedStepScheduler::GetAlpha() const
+{
+	return m_accumulator / m_timeStep;
+}
+
+unsigned int FixedStepScheduler::GetMaxStepCount() const
+{
+	return m_maxStepCount;
+}
+
+float FixedStepScheduler::GetTimeStep() const
+{
+	return m_timeStep;
+}
+
+void FixedStepScheduler::SetMaxStepCount(unsigned int maxStepCount)
+{
+	m_maxStepCount = maxStepCount;
+}
+
+void FixedStepScheduler::SetTimeStep(float timeStep)
+{
+	assert(timeStep > 0.f);
+	m_timeStep = timeStep;
+}
+
+unsigned int FixedStepScheduler::Update(float deltaTime)
+{
+	m_accumulator += deltaTime;
+
+	unsigned int stepCount = 0;
+	while (m_accumulator >= m_timeStep && stepCount < m_maxStepCount)
+	{
+		for (System& system : m_systems)
+			system(m_timeStep);
+
+		m_accumulator -= m_timeStep;
+		stepCount++;
+	}
+
+	// After a long frame (loading, breakpoint...) we drop the late time instead of trying to catch up,
+	// otherwise each frame would get slower than the previous one
+	if (m_accumulator >= m_timeStep)
+		m_accumulator = 0.f;
+
+	return stepCount;
+}
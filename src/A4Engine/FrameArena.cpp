@@ -0,0 +1,104 @@
+#include <A4Engine/FrameArena.hpp>
+#include <atomic>
+#include <stdexcept>
+
+namespace
+{
+	// A frame arena created after another one must not reuse the arenas of the previous one
+	std::atomic<std::uint64_t> s_nextGeneration{ 1 };
+
+	struct ThreadSlot
+	{
+		std::uint64_t generation = 0;
+		LinearArena* arena = nullptr;
+	};
+
+	thread_local ThreadSlot s_threadSlot;
+}
+
+FrameArena::FrameArena(std::size_t blockSize) :
+m_blockSize(blockSize),
+m_capacity(0),
+m_lastFrameUsage(0),
+m_generation(s_nextGeneration.fetch_add(1, std::memory_order_relaxed))
+{
+	if (s_instance != nullptr)
+		throw std::runtime_error("only one FrameArena can be created");
+
+	s_instance = this;
+}
+
+FrameArena::~FrameArena()
+{
+	s_instance = nullptr;
+}
+
+void FrameArena::EndFrame()
+{
+	std::lock_guard<std::mutex> lock(m_arenaMutex);
+
+	m_capacity = 0;
+	m_lastFrameUsage = 0;
+	for (const std::unique_ptr<LinearArena>& arena : m_arenas)
+	{
+		m_capacity += arena->GetCapacity();
+		m_lastFrameUsage += arena->GetUsage();
+		arena->Reset();
+	}
+}
+
+std::size_t FrameArena::GetCapacity() const
+{
+	return m_capacity;
+}
+
+std::size_t FrameArena::GetLastFrameUsage() const
+{
+	return m_lastFrameUsage;
+}
+
+std::size_t FrameArena::GetThreadCount() const
+{
+	std::lock_guard<std::mutex> lock(m_arenaMutex);
+	return m_arenas.size();
+}
+
+FrameArena& FrameArena::Instance()
+{
+	if (s_instance == nullptr)
+		throw std::runtime_error("FrameArena hasn't been instantied");
+
+	return *s_instance;
+}
+
+bool FrameArena::IsEnabled()
+{
+	return s_instance != nullptr;
+}
+
+std::pmr::memory_resource* FrameArena::GetResource()
+{
+	if (s_instance == nullptr)
+		return std::pmr::get_default_resource();
+
+	return &s_instance->GetThreadArena();
+}
+
+LinearArena& FrameArena::GetThreadArena()
+{
+	if (s_threadSlot.generation == m_generation)
+		return *s_threadSlot.arena;
+
+	// First use from this thread
+	std::unique_ptr<LinearArena> arena = std::make_unique<LinearArena>(m_blockSize);
+
+	s_threadSlot.generation = m_generation;
+	s_threadSlot.arena = arena.get();
+
+	std::lock_guard<std::mutex> lock(m_arenaMutex);
+	m_arenas.push_back(std::move(arena));
+
+	return *s_threadSlot.arena;
+}
+
+FrameArena* FrameArena::s_instance = nullptr;
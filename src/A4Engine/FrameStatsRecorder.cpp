@@ -0,0 +1,209 @@
+#include <A4Engine/FrameStatsRecorder.hpp>
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <fmt/std.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iterator>
+
+namespace
+{
+	// The writer wakes up periodically, or as soon as the ring is half full
+	constexpr std::chrono::milliseconds WriterPeriod(50);
+}
+
+FrameStatsRecorder::FrameStatsRecorder(std::size_t rowCapacity) :
+m_columnNames({ "frame" }),
+m_rowHead(0),
+m_rowTail(0),
+m_droppedFrameCount(0),
+m_rowCapacity(std::max<std::size_t>(rowCapacity, 1)),
+m_frameIndex(0),
+m_format(FrameStatsFormat::CSV),
+m_recording(false),
+m_stopping(false)
+{
+	m_currentRow.resize(m_columnNames.size(), 0.0);
+}
+
+FrameStatsRecorder::~FrameStatsRecorder()
+{
+	Stop();
+}
+
+std::size_t FrameStatsRecorder::AddColumn(std::string name)
+{
+	assert(!m_recording);
+
+	m_columnNames.push_back(std::move(name));
+	m_currentRow.resize(m_columnNames.size(), 0.0);
+
+	return m_columnNames.size() - 1;
+}
+
+void FrameStatsRecorder::EndFrame()
+{
+	m_frameIndex++;
+	if (!m_recording)
+		return;
+
+	m_currentRow[0] = static_cast<double>(m_frameIndex);
+
+	std::size_t head = m_rowHead.load(std::memory_order_relaxed);
+	std::size_t queuedRowCount = head - m_rowTail.load(std::memory_order_acquire);
+	if (queuedRowCount >= m_rowCapacity)
+		m_droppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+	else
+	{
+		std::copy(m_currentRow.begin(), m_currentRow.end(), m_rows.begin() + (head % m_rowCapacity) * m_currentRow.size());
+		m_rowHead.store(head + 1, std::memory_order_release);
+
+		if (queuedRowCount + 1 == m_rowCapacity / 2)
+			m_stopCondition.notify_one();
+	}
+
+	std::fill(m_currentRow.begin(), m_currentRow.end(), 0.0);
+}
+
+std::size_t FrameStatsRecorder::GetDroppedFrameCount() const
+{
+	return m_droppedFrameCount.load(std::memory_order_relaxed);
+}
+
+std::uint64_t FrameStatsRecorder::GetFrameIndex() const
+{
+	return m_frameIndex;
+}
+
+bool FrameStatsRecorder::IsRecording() const
+{
+	return m_recording;
+}
+
+void FrameStatsRecorder::Set(std::size_t column, double value)
+{
+	assert(column < m_currentRow.size());
+	if (m_recording)
+		m_currentRow[column] = value;
+}
+
+bool FrameStatsRecorder::Start(const std::filesystem::path& filepath, FrameStatsFormat format)
+{
+	Stop();
+
+	m_file.open(filepath, std::ios::trunc);
+	if (!m_file)
+	{
+		fmt::print(stderr, fg(fmt::color::red), "failed to open frame stats file {}\n", filepath);
+		return false;
+	}
+
+	m_format = format;
+	m_rows.assign(m_rowCapacity * m_columnNames.size(), 0.0);
+	m_rowHead.store(0, std::memory_order_relaxed);
+	m_rowTail.store(0, std::memory_order_relaxed);
+	m_droppedFrameCount.store(0, std::memory_order_relaxed);
+	std::fill(m_currentRow.begin(), m_currentRow.end(), 0.0);
+
+	WriteHeader();
+
+	m_stopping = false;
+	m_recording = true;
+	m_writerThread = std::thread(&FrameStatsRecorder::WriterLoop, this);
+
+	return true;
+}
+
+void FrameStatsRecorder::Stop()
+{
+	if (!m_recording)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_stopMutex);
+		m_stopping = true;
+	}
+	m_stopCondition.notify_one();
+
+	m_writerThread.join();
+	m_recording = false;
+
+	m_file.close();
+}
+
+void FrameStatsRecorder::WriteHeader()
+{
+	if (m_format != FrameStatsFormat::CSV)
+		return;
+
+	for (std::size_t i = 0; i < m_columnNames.size(); ++i)
+	{
+		if (i > 0)
+			m_file << ',';
+
+		m_file << m_columnNames[i];
+	}
+	m_file << '\n';
+}
+
+void FrameStatsRecorder::WriteRow(const double* row)
+{
+	// Formatted into a reused buffer, the file gets one write per row
+	m_lineBuffer.clear();
+	auto out = std::back_inserter(m_lineBuffer);
+
+	// 9 significant digits: exact for frame indices and counters, more than enough for float timings
+	if (m_format == FrameStatsFormat::CSV)
+	{
+		for (std::size_t i = 0; i < m_columnNames.size(); ++i)
+		{
+			if (i > 0)
+				m_lineBuffer += ',';
+
+			fmt::format_to(out, "{:.9g}", row[i]);
+		}
+	}
+	else
+	{
+		m_lineBuffer += '{';
+		for (std::size_t i = 0; i < m_columnNames.size(); ++i)
+		{
+			if (i > 0)
+				m_lineBuffer += ',';
+
+			fmt::format_to(out, "\"{}\":{:.9g}", m_columnNames[i], row[i]);
+		}
+		m_lineBuffer += '}';
+	}
+
+	m_lineBuffer += '\n';
+	m_file.write(m_lineBuffer.data(), static_cast<std::streamsize>(m_lineBuffer.size()));
+}
+
+void FrameStatsRecorder::WriterLoop()
+{
+	bool stopping = false;
+	while (!stopping)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_stopMutex);
+			m_stopCondition.wait_for(lock, WriterPeriod, [&]
+			{
+				return m_stopping || m_rowHead.load(std::memory_order_relaxed) - m_rowTail.load(std::memory_order_relaxed) >= m_rowCapacity / 2;
+			});
+			stopping = m_stopping;
+		}
+
+		// Rows queued before Stop are still written
+		std::size_t tail = m_rowTail.load(std::memory_order_relaxed);
+		std::size_t head = m_rowHead.load(std::memory_order_acquire);
+		for (; tail != head; ++tail)
+		{
+			WriteRow(&m_rows[(tail % m_rowCapacity) * m_columnNames.size()]);
+			m_rowTail.store(tail + 1, std::memory_order_release);
+		}
+
+		m_file.flush();
+	}
+}
@@ -1,4 +1,5 @@
 #include <A4Engine/InputManager.hpp>
+#include <cassert>
 #include <stdexcept>
 
 InputManager::InputManager()
@@ -14,16 +15,25 @@ InputManager::~InputManager()
 	s_instance = nullptr;
 }
 
-void InputManager::BindKeyPressed(SDL_KeyCode keyCode, std::string action)
+void InputManager::BindKeyPressed(SDL_KeyCode keyCode, ActionId action)
 {
-	if (!action.empty())
-		m_keyToAction[keyCode] = std::move(action);
+	assert(action == InvalidAction || action < m_actions.size());
+
+	if (action != InvalidAction)
+		m_keyToAction[keyCode] = action;
 	else
 		m_keyToAction.erase(keyCode);
 }
 
-void InputManager::BindMouseButtonPressed(MouseButton button, std::string action)
+void InputManager::BindKeyPressed(SDL_KeyCode keyCode, const std::string& action)
+{
+	BindKeyPressed(keyCode, (!action.empty()) ? GetActionId(action) : InvalidAction);
+}
+
+void InputManager::BindMouseButtonPressed(MouseButton button, ActionId action)
 {
+	assert(action == InvalidAction || action < m_actions.size());
+
 	// Plutôt que de traduire depuis notre enum vers les defines de la SDL à chaque événement
 	// on peut le faire une seule fois au binding (plus efficace)
 	int mouseButton;
@@ -38,12 +48,30 @@ void InputManager::BindMouseButtonPressed(MouseButton button, std::string action
 			return; //< ne devrait pas arriver
 	}
 
-	m_mouseButtonToAction[mouseButton] = std::move(action);
+	if (action != InvalidAction)
+		m_mouseButtonToAction[mouseButton] = action;
+	else
+		m_mouseButtonToAction.erase(mouseButton);
 }
 
-void InputManager::BindControllerButton(SDL_GameControllerButton button, std::string action)
+void InputManager::BindMouseButtonPressed(MouseButton button, const std::string& action)
 {
-	m_controllerButtonToAction[button] = std::move(action);
+	BindMouseButtonPressed(button, (!action.empty()) ? GetActionId(action) : InvalidAction);
+}
+
+void InputManager::BindControllerButton(SDL_GameControllerButton button, ActionId action)
+{
+	assert(action == InvalidAction || action < m_actions.size());
+
+	if (action != InvalidAction)
+		m_controllerButtonToAction[button] = action;
+	else
+		m_controllerButtonToAction.erase(button);
+}
+
+void InputManager::BindControllerButton(SDL_GameControllerButton button, const std::string& action)
+{
+	BindControllerButton(button, (!action.empty()) ? GetActionId(action) : InvalidAction);
 }
 
 void InputManager::ClearBindings()
@@ -53,6 +81,32 @@ void InputManager::ClearBindings()
 	m_keyToAction.clear();
 }
 
+ActionId InputManager::GetActionId(const ActionName& action)
+{
+	ActionId actionId = FindActionId(action.hash);
+	if (actionId != InvalidAction)
+	{
+		// Deux noms différents de même hachage seraient confondus sans bruit
+		if (m_actions[actionId].name != action.name)
+			throw std::runtime_error("input action \"" + std::string(action.name) + "\" hash collides with \"" + m_actions[actionId].name + "\"");
+
+		return actionId;
+	}
+
+	return RegisterAction(action.name, action.hash);
+}
+
+ActionId InputManager::GetActionId(std::string_view action)
+{
+	return GetActionId(ActionName(action));
+}
+
+const std::string& InputManager::GetActionName(ActionId action) const
+{
+	assert(action < m_actions.size());
+	return m_actions[action].name;
+}
+
 void InputManager::HandleEvent(const SDL_Event& event)
 {
 	switch (event.type)
@@ -113,20 +167,47 @@ void InputManager::HandleEvent(const SDL_Event& event)
 	}
 }
 
+bool InputManager::IsActive(ActionId action) const
+{
+	return action < MaxActionCount && m_activeActions.test(action);
+}
+
+bool InputManager::IsActive(const ActionName& action) const
+{
+	// Une action jamais enregistrée ne peut pas être en cours
+	return IsActive(FindActionId(action.hash));
+}
+
 bool InputManager::IsActive(const std::string& action) const
 {
-	auto it = m_actions.find(action);
-	if (it == m_actions.end())
-		return false;
+	return IsActive(ActionName(action));
+}
+
+void InputManager::NewFrame()
+{
+	m_pressedActions.reset();
+	m_releasedActions.reset();
+}
 
-	const ActionData& actionData = it->second;
-	return actionData.isActive;
+void InputManager::OnAction(ActionId action, std::function<void(bool)> func)
+{
+	assert(action < m_actions.size());
+	m_actions[action].func = std::move(func);
 }
 
-void InputManager::OnAction(std::string action, std::function<void(bool)> func)
+void InputManager::OnAction(const std::string& action, std::function<void(bool)> func)
 {
-	ActionData& actionData = GetActionData(action);
-	actionData.func = std::move(func);
+	OnAction(GetActionId(action), std::move(func));
+}
+
+bool InputManager::WasPressed(ActionId action) const
+{
+	return action < MaxActionCount && m_pressedActions.test(action);
+}
+
+bool InputManager::WasReleased(ActionId action) const
+{
+	return action < MaxActionCount && m_releasedActions.test(action);
 }
 
 InputManager& InputManager::Instance()
@@ -137,32 +218,54 @@ InputManager& InputManager::Instance()
 	return *s_instance;
 }
 
-InputManager::ActionData& InputManager::GetActionData(const std::string& action)
+ActionId InputManager::FindActionId(std::uint64_t hash) const
 {
-	auto it = m_actions.find(action);
-	if (it != m_actions.end())
-		return it->second;
-	else
-	{
-		ActionData& actionData = m_actions[action];
-		actionData.isActive = false;
+	auto it = m_actionIds.find(hash);
+	if (it == m_actionIds.end())
+		return InvalidAction;
 
-		return actionData;
-	}
+	return it->second;
+}
+
+ActionId InputManager::RegisterAction(std::string_view action, std::uint64_t hash)
+{
+	if (m_actions.size() >= MaxActionCount)
+		throw std::runtime_error("too many input actions");
+
+	ActionId actionId = static_cast<ActionId>(m_actions.size());
+	m_actionIds.emplace(hash, actionId);
+
+	ActionData& actionData = m_actions.emplace_back();
+	actionData.name = action;
+
+	return actionId;
 }
 
-void InputManager::TriggerAction(const std::string& action)
+void InputManager::TriggerAction(ActionId action)
 {
-	ActionData& actionData = GetActionData(action);
-	actionData.isActive = true;
+	assert(action < m_actions.size());
+
+	// Les répétitions de touche maintenue relancent l'action mais ne sont pas un nouvel appui
+	if (!m_activeActions.test(action))
+		m_pressedActions.set(action);
+
+	m_activeActions.set(action);
+
+	ActionData& actionData = m_actions[action];
 	if (actionData.func)
 		actionData.func(true);
 }
 
-void InputManager::ReleaseAction(const std::string& action)
+void InputManager::ReleaseAction(ActionId action)
 {
-	ActionData& actionData = GetActionData(action);
-	actionData.isActive = false;
+	assert(action < m_actions.size());
+
+	if (m_activeActions.test(action))
+		m_releasedActions.set(action);
+
+	m_activeActions.reset(action);
+
+	ActionData& actionData = m_actions[action];
 	if (actionData.func)
 		actionData.func(false);
 }
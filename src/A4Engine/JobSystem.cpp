@@ -0,0 +1,346 @@
+#include <A4Engine/JobSystem.hpp>
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace
+{
+	// Index of the worker running on this thread, the main thread (and any other) isn't one
+	constexpr std::size_t NoWorker = static_cast<std::size_t>(-1);
+	thread_local std::size_t s_workerIndex = NoWorker;
+}
+
+bool JobCounter::IsDone() const
+{
+	return m_pendingCount.load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::JobSystem(unsigned int workerCount) :
+	m_mainThreadId(std::this_thread::get_id()),
+	m_queuedJobCount(0),
+	m_nextWorker(0),
+	m_running(true)
+{
+	if (s_instance != nullptr)
+		throw std::runtime_error("only one JobSystem can be created");
+
+	if (workerCount == 0)
+		workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+	// Workers are all created before any of them starts, they steal from each other
+	m_workers.reserve(workerCount);
+	for (unsigned int i = 0; i < workerCount; ++i)
+		m_workers.push_back(std::make_unique<Worker>());
+
+	for (std::size_t i = 0; i < m_workers.size(); ++i)
+		m_workers[i]->thread = std::thread(&JobSystem::WorkerLoop, this, i);
+
+	s_instance = this;
+}
+
+JobSystem::~JobSystem()
+{
+	// Queued jobs are run rather than dropped, their counters would never be done: first with the workers' help,
+	// then once they are stopped, for what the jobs they were still running queued
+	DrainJobs();
+
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_running = false;
+	}
+	m_wakeCondition.notify_all();
+
+	for (std::unique_ptr<Worker>& worker : m_workers)
+		worker->thread.join();
+
+	DrainJobs();
+
+	s_instance = nullptr;
+}
+
+unsigned int JobSystem::GetWorkerCount() const
+{
+	return static_cast<unsigned int>(m_workers.size());
+}
+
+bool JobSystem::IsMainThread() const
+{
+	return std::this_thread::get_id() == m_mainThreadId;
+}
+
+void JobSystem::RunMainThreadJobs()
+{
+	std::vector<Job> jobs;
+	{
+		std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+		jobs.swap(m_mainThreadJobs);
+	}
+
+	for (Job& job : jobs)
+		Run(job);
+}
+
+void JobSystem::Schedule(std::function<void()> job, JobCounter* counter)
+{
+	if (counter)
+		counter->m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+	Push({ std::move(job), counter });
+}
+
+void JobSystem::ScheduleAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter)
+{
+	if (counter)
+		counter->m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+	{
+		// Checked under the lock: the job finishing the dependency takes the continuations under it too
+		std::lock_guard<std::mutex> lock(dependency.m_continuationMutex);
+		if (!dependency.IsDone())
+		{
+			dependency.m_continuations.push_back({ std::move(job), counter });
+			return;
+		}
+	}
+
+	Push({ std::move(job), counter });
+}
+
+void JobSystem::ScheduleOnMainThread(std::function<void()> job, JobCounter* counter)
+{
+	if (counter)
+		counter->m_pendingCount.fetch_add(1, std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+	m_mainThreadJobs.push_back({ std::move(job), counter });
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	bool isMainThread = IsMainThread();
+	while (!counter.IsDone())
+	{
+		if (TryRunJob())
+			continue;
+
+		// What we wait for may depend on a main thread job, which only we can run
+		if (isMainThread)
+			RunMainThreadJobs();
+
+		std::this_thread::yield();
+	}
+
+	// The thread which ran the last job may still be releasing the lock
+	std::lock_guard<std::mutex> lock(counter.m_continuationMutex);
+}
+
+void JobSystem::DrainJobs()
+{
+	for (;;)
+	{
+		if (TryRunJob())
+			continue;
+
+		bool hasMainThreadJobs;
+		{
+			std::lock_guard<std::mutex> lock(m_mainThreadMutex);
+			hasMainThreadJobs = !m_mainThreadJobs.empty();
+		}
+
+		if (hasMainThreadJobs)
+			RunMainThreadJobs();
+		else if (m_queuedJobCount.load(std::memory_order_acquire) == 0)
+			break;
+		else
+			std::this_thread::yield(); //< a worker is between pushing a job and counting it
+	}
+}
+
+void JobSystem::Push(Job job)
+{
+	// Workers push to their own queue, other threads spread their jobs over the workers
+	if (m_workers.empty())
+	{
+		Run(job); //< nobody else could run it
+		return;
+	}
+
+	std::size_t workerIndex = s_workerIndex;
+	if (workerIndex == NoWorker)
+		workerIndex = m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+
+	Worker& worker = *m_workers[workerIndex];
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.jobs.PushBack(std::move(job));
+	}
+
+	{
+		// Taking the lock makes sure a worker about to sleep sees the new count
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_queuedJobCount.fetch_add(1, std::memory_order_release);
+	}
+	m_wakeCondition.notify_one();
+}
+
+void JobSystem::Run(Job& job)
+{
+	job.function();
+
+	JobCounter* counter = job.counter;
+	if (!counter)
+		return;
+
+	// Decremented under the lock: ScheduleAfter checks the counter under it, and Wait takes it once before returning
+	// so the counter can't be destroyed while we still hold it
+	std::vector<JobCounter::Continuation> continuations;
+	{
+		std::lock_guard<std::mutex> lock(counter->m_continuationMutex);
+		if (counter->m_pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			continuations.swap(counter->m_continuations); //< last job of the counter, what was waiting for it can start
+	}
+
+	for (JobCounter::Continuation& continuation : continuations)
+		Push({ std::move(continuation.function), continuation.counter });
+}
+
+bool JobSystem::TryPop(std::size_t workerIndex, Job& job)
+{
+	Worker& worker = *m_workers[workerIndex];
+
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (worker.jobs.IsEmpty())
+		return false;
+
+	job = worker.jobs.PopBack();
+	m_queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+
+	return true;
+}
+
+bool JobSystem::TryRunJob()
+{
+	Job job;
+
+	std::size_t workerIndex = s_workerIndex;
+	if ((workerIndex != NoWorker && TryPop(workerIndex, job)) || TrySteal(workerIndex, job))
+	{
+		Run(job);
+		return true;
+	}
+
+	return false;
+}
+
+bool JobSystem::TrySteal(std::size_t thiefIndex, Job& job)
+{
+	// Oldest jobs first: they are usually the biggest (not yet split) and the least likely to be in the owner's cache
+	std::size_t workerCount = m_workers.size();
+	std::size_t start = (thiefIndex != NoWorker) ? thiefIndex + 1 : 0;
+	for (std::size_t i = 0; i < workerCount; ++i)
+	{
+		std::size_t victimIndex = (start + i) % workerCount;
+		if (victimIndex == thiefIndex)
+			continue;
+
+		Worker& victim = *m_workers[victimIndex];
+
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (victim.jobs.IsEmpty())
+			continue;
+
+		job = victim.jobs.PopFront();
+		m_queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	return false;
+}
+
+void JobSystem::WorkerLoop(std::size_t workerIndex)
+{
+	s_workerIndex = workerIndex;
+
+	for (;;)
+	{
+		if (TryRunJob())
+			continue;
+
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+		m_wakeCondition.wait(lock, [&] { return !m_running || m_queuedJobCount.load(std::memory_order_acquire) > 0; });
+
+		if (!m_running)
+			break;
+	}
+}
+
+JobSystem& JobSystem::Instance()
+{
+	if (s_instance == nullptr)
+		throw std::runtime_error("JobSystem hasn't been instantied");
+
+	return *s_instance;
+}
+
+JobSystem* JobSystem::TryInstance()
+{
+	return s_instance;
+}
+
+unsigned int JobSystem::GetCurrentThreadIndex()
+{
+	if (s_workerIndex == NoWorker)
+		return 0;
+
+	return static_cast<unsigned int>(s_workerIndex + 1);
+}
+
+bool JobSystem::JobQueue::IsEmpty() const
+{
+	return m_count == 0;
+}
+
+JobSystem::Job JobSystem::JobQueue::PopBack()
+{
+	assert(m_count > 0);
+
+	Job& slot = m_jobs[(m_first + m_count - 1) % m_jobs.size()];
+	Job job = std::move(slot);
+	slot.function = nullptr; //< releases what the job captured right away
+	m_count--;
+
+	return job;
+}
+
+JobSystem::Job JobSystem::JobQueue::PopFront()
+{
+	assert(m_count > 0);
+
+	Job& slot = m_jobs[m_first];
+	Job job = std::move(slot);
+	slot.function = nullptr;
+	m_first = (m_first + 1) % m_jobs.size();
+	m_count--;
+
+	return job;
+}
+
+void JobSystem::JobQueue::PushBack(Job job)
+{
+	if (m_count == m_jobs.size())
+	{
+		// Full: jobs are moved in order at the start of a twice bigger buffer
+		std::vector<Job> jobs(std::max<std::size_t>(m_jobs.size() * 2, 64));
+		for (std::size_t i = 0; i < m_count; ++i)
+			jobs[i] = std::move(m_jobs[(m_first + i) % m_jobs.size()]);
+
+		m_jobs.swap(jobs);
+		m_first = 0;
+	}
+
+	m_jobs[(m_first + m_count) % m_jobs.size()] = std::move(job);
+	m_count++;
+}
+
+JobSystem* JobSystem::s_instance = nullptr;
@@ -0,0 +1,133 @@
+#include "A4Engine/MappedFile.hpp"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const char* path) :
+	m_data(nullptr),
+	m_size(0)
+{
+#ifdef _WIN32
+	m_mappingHandle = nullptr;
+	m_fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		m_fileHandle = nullptr;
+		return;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(m_fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return;
+	}
+
+	m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_mappingHandle)
+	{
+		Close();
+		return;
+	}
+
+	m_data = static_cast<const std::uint8_t*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!m_data)
+	{
+		Close();
+		return;
+	}
+
+	m_size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return;
+
+	struct stat fileInfo;
+	if (fstat(fd, &fileInfo) == 0 && fileInfo.st_size > 0)
+	{
+		void* data = mmap(nullptr, static_cast<std::size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED)
+		{
+			m_data = static_cast<const std::uint8_t*>(data);
+			m_size = static_cast<std::size_t>(fileInfo.st_size);
+		}
+	}
+
+	// The mapping stays valid once the descriptor is closed
+	close(fd);
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& file) noexcept :
+	m_data(std::exchange(file.m_data, nullptr)),
+	m_size(std::exchange(file.m_size, 0))
+#ifdef _WIN32
+	,
+	m_fileHandle(std::exchange(file.m_fileHandle, nullptr)),
+	m_mappingHandle(std::exchange(file.m_mappingHandle, nullptr))
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+const std::uint8_t* MappedFile::GetData() const
+{
+	return m_data;
+}
+
+std::size_t MappedFile::GetSize() const
+{
+	return m_size;
+}
+
+bool MappedFile::IsValid() const
+{
+	return m_data != nullptr;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& file) noexcept
+{
+	std::swap(m_data, file.m_data);
+	std::swap(m_size, file.m_size);
+#ifdef _WIN32
+	std::swap(m_fileHandle, file.m_fileHandle);
+	std::swap(m_mappingHandle, file.m_mappingHandle);
+#endif
+	return *this;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (m_data)
+		UnmapViewOfFile(m_data);
+
+	if (m_mappingHandle)
+		CloseHandle(m_mappingHandle);
+
+	if (m_fileHandle)
+		CloseHandle(m_fileHandle);
+
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+#else
+	if (m_data)
+		munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
@@ -0,0 +1,98 @@
+#include <A4Engine/MemoryPool.hpp>
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+MemoryPool::MemoryPool(std::size_t slotSize, std::size_t slotsPerBlock) :
+m_freeList(nullptr),
+m_allocatedCount(0),
+m_slotsPerBlock(slotsPerBlock)
+{
+	assert(slotsPerBlock > 0);
+
+	// Every slot must be able to hold the free list link and keep the alignment of any type
+	constexpr std::size_t Alignment = alignof(std::max_align_t);
+	slotSize = std::max(slotSize, sizeof(FreeSlot));
+	m_slotSize = (slotSize + Alignment - 1) / Alignment * Alignment;
+}
+
+MemoryPool::MemoryPool(MemoryPool&& pool) noexcept :
+m_blocks(std::move(pool.m_blocks)),
+m_freeList(std::exchange(pool.m_freeList, nullptr)),
+m_allocatedCount(std::exchange(pool.m_allocatedCount, 0)),
+m_slotSize(pool.m_slotSize),
+m_slotsPerBlock(pool.m_slotsPerBlock)
+{
+}
+
+MemoryPool::~MemoryPool()
+{
+	// Slots are raw memory, the pool can't run destructors: everything must have been freed by its owner
+	assert(m_allocatedCount == 0);
+}
+
+void* MemoryPool::Allocate()
+{
+	if (!m_freeList)
+		AddBlock();
+
+	FreeSlot* slot = m_freeList;
+	m_freeList = slot->next;
+	m_allocatedCount++;
+
+	return slot;
+}
+
+void MemoryPool::Free(void* slot)
+{
+	if (!slot)
+		return;
+
+	assert(m_allocatedCount > 0);
+
+	FreeSlot* freeSlot = static_cast<FreeSlot*>(slot);
+	freeSlot->next = m_freeList;
+	m_freeList = freeSlot;
+	m_allocatedCount--;
+}
+
+std::size_t MemoryPool::GetAllocatedCount() const
+{
+	return m_allocatedCount;
+}
+
+std::size_t MemoryPool::GetCapacity() const
+{
+	return m_blocks.size() * m_slotsPerBlock;
+}
+
+std::size_t MemoryPool::GetSlotSize() const
+{
+	return m_slotSize;
+}
+
+MemoryPool& MemoryPool::operator=(MemoryPool&& pool) noexcept
+{
+	std::swap(m_blocks, pool.m_blocks);
+	std::swap(m_freeList, pool.m_freeList);
+	std::swap(m_allocatedCount, pool.m_allocatedCount);
+	std::swap(m_slotSize, pool.m_slotSize);
+	std::swap(m_slotsPerBlock, pool.m_slotsPerBlock);
+	return *this;
+}
+
+void MemoryPool::AddBlock()
+{
+	// operator new[] aligns on at least alignof(std::max_align_t), and so does every slot size
+	std::unique_ptr<std::byte[]> block = std::make_unique<std::byte[]>(m_slotSize * m_slotsPerBlock);
+
+	// Slots are linked in address order so consecutive allocations stay close in memory
+	for (std::size_t i = m_slotsPerBlock; i-- > 0;)
+	{
+		FreeSlot* slot = reinterpret_cast<FreeSlot*>(block.get() + i * m_slotSize);
+		slot->next = m_freeList;
+		m_freeList = slot;
+	}
+
+	m_blocks.push_back(std::move(block));
+}
@@ -1,4 +1,6 @@
 #include <A4Engine/Model.hpp>
+#include <A4Engine/FrameArena.hpp>
+#include <A4Engine/Profiler.hpp>
 #include <A4Engine/ResourceManager.hpp>
 #include <A4Engine/SDLppRenderer.hpp>
 #include <A4Engine/SDLppTexture.hpp>
@@ -10,6 +12,7 @@
 #include <nlohmann/json.hpp>
 #include <cassert>
 #include <fstream>
+#include <memory_resource>
 
 constexpr unsigned int FileVersion = 1;
 
@@ -46,6 +49,8 @@ m_indices(std::move(indices))
 
 void Model::Draw(SDLppRenderer& renderer, const Matrix3& transformMatrix /*const Transform& cameraTransform, const Transform& transform*/)
 {
+	A4_PROFILE_ZONE("Model::Draw");
+
 	// On s'assure que les deux tableaux font la même taille (assert crash immédiatement le programme si la condition passée est fausse)
 	assert(m_vertices.size() == m_sdlVertices.size());
 	for (std::size_t i = 0; i < m_vertices.size(); ++i)
@@ -59,20 +64,32 @@ void Model::Draw(SDLppRenderer& renderer, const Matrix3& transformMatrix /*const
 
 	if (!m_indices.empty())
 	{
-		SDL_RenderGeometry(renderer.GetHandle(),
-			(m_texture) ? m_texture->GetHandle() : nullptr,
+		renderer.RenderGeometry(m_texture.get(),
 			m_sdlVertices.data(), static_cast<int>(m_sdlVertices.size()),
 			m_indices.data(), static_cast<int>(m_indices.size()));
 	}
 	else
 	{
-		SDL_RenderGeometry(renderer.GetHandle(),
-			(m_texture) ? m_texture->GetHandle() : nullptr,
-			m_sdlVertices.data(), static_cast<int>(m_sdlVertices.size()),
-			nullptr, 0);
+		renderer.RenderGeometry(m_texture.get(),
+			m_sdlVertices.data(), static_cast<int>(m_sdlVertices.size()));
 	}
 }
 
+const std::vector<int>& Model::GetIndices() const
+{
+	return m_indices;
+}
+
+std::size_t Model::GetMemoryUsage() const
+{
+	return m_vertices.capacity() * sizeof(ModelVertex) + m_sdlVertices.capacity() * sizeof(SDL_Vertex) + m_indices.capacity() * sizeof(int);
+}
+
+const std::vector<ModelVertex>& Model::GetVertices() const
+{
+	return m_vertices;
+}
+
 bool Model::IsValid() const
 {
 	// Un modèle peut ne pas avoir de texture/indices, mais il a forcément des vertices
@@ -370,8 +387,8 @@ Model Model::LoadFromFileCompressed(const std::filesystem::path& filepath)
 		return {}; //< on retourne un Model construit par défaut (on pourrait également lancer une exception)
 	}
 
-	// On lit tout le contenu dans un vector
-	std::vector<char> content((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>());
+	// On lit tout le contenu dans un vector, celui-ci (comme le tampon décompressé) ne sert que pendant le chargement : il est alloué dans la FrameArena
+	std::pmr::vector<char> content((std::istreambuf_iterator<char>(inputFile)), std::istreambuf_iterator<char>(), FrameArena::GetResource());
 
 	// Nous devons allouer un tableau d'une taille suffisante pour stocker la version décompressée : problème, nous n'avons pas cette information
 	// Nous l'avons donc stockée dans un Uint32 au début du fichier
@@ -385,15 +402,16 @@ Model Model::LoadFromFileCompressed(const std::filesystem::path& filepath)
 		return {};
 	}
 
-	// Nous pouvons ensuite allouer un tableau d'octets (char), std::vector<char> ferait l'affaire ici mais un unique_ptr suffit amplement
-	std::unique_ptr<char[]> decompressedStr = std::make_unique<char[]>(decompressedSize);
-	if (LZ4_decompress_safe(&content[sizeof(Uint32)], decompressedStr.get(), static_cast<int>(content.size() - sizeof(Uint32)), decompressedSize) <= 0)
+	// Nous pouvons ensuite allouer un tableau d'octets (char)
+	std::pmr::vector<char> decompressedStr(decompressedSize, FrameArena::GetResource());
+	if (LZ4_decompress_safe(&content[sizeof(Uint32)], decompressedStr.data(), static_cast<int>(content.size() - sizeof(Uint32)), decompressedSize) <= 0)
 	{
 		fmt::print(stderr, fg(fmt::color::red), "failed to load model file {}: corrupt file\n", filepath);
 		return {};
 	}
 
-	return LoadFromJSon(nlohmann::json::parse(decompressedStr.get()));
+	// Le JSON compressé n'a pas de \0 final, on donne donc le début et la fin des données
+	return LoadFromJSon(nlohmann::json::parse(decompressedStr.begin(), decompressedStr.end()));
 }
 
 Model Model::LoadFromFileBinary(const std::filesystem::path& filepath)
@@ -0,0 +1,259 @@
+#include <A4Engine/PerformanceOverlay.hpp>
+#include <A4Engine/AllocationTracker.hpp>
+#include <A4Engine/FrameArena.hpp>
+#include <A4Engine/PhysicsSystem.h>
+#include <A4Engine/Profiler.hpp>
+#include <A4Engine/ResourceManager.hpp>
+#include <A4Engine/SDLppRenderer.hpp>
+#include <A4Engine/SystemScheduler.hpp>
+#include <imgui.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	constexpr float ZoneSmoothing = 0.1f; //< weight of the last frame in the displayed zone and system times
+
+	void ResourceText(const char* className, const ResourceClassUsage& usage)
+	{
+		ImGui::Text("%-20s %4zu  %10.1f KiB", className, usage.count, usage.memory / 1024.0);
+	}
+}
+
+PerformanceOverlay::PerformanceOverlay(std::size_t frameCapacity) :
+m_frameTimes(std::max<std::size_t>(frameCapacity, 1), 0.f),
+m_sortedFrameTimes(m_frameTimes.size()),
+m_zoneFrameTimes(MaxZoneCount),
+m_frameCount(0),
+m_nextFrame(0),
+m_physicsSystem(nullptr),
+m_renderer(nullptr),
+m_systemScheduler(nullptr)
+{
+	m_histogram.fill(0.f);
+	m_zones.reserve(MaxZoneCount);
+}
+
+void PerformanceOverlay::AddFrame(float frameTime)
+{
+	m_frameTimes[m_nextFrame] = frameTime * 1000.f;
+	m_nextFrame = (m_nextFrame + 1) % m_frameTimes.size();
+	m_frameCount = std::min(m_frameCount + 1, m_frameTimes.size());
+
+	UpdateSystems();
+	UpdateZones();
+}
+
+void PerformanceOverlay::Draw()
+{
+	ImGui::Begin("Performance");
+
+	if (ImGui::CollapsingHeader("Frame times", ImGuiTreeNodeFlags_DefaultOpen))
+		DrawFrameTimes();
+
+	if (m_systemScheduler && ImGui::CollapsingHeader("Systems", ImGuiTreeNodeFlags_DefaultOpen))
+		DrawSystems();
+
+	if (ImGui::CollapsingHeader("Zones", ImGuiTreeNodeFlags_DefaultOpen))
+		DrawZones();
+
+	if (m_renderer && ImGui::CollapsingHeader("Renderer", ImGuiTreeNodeFlags_DefaultOpen))
+		DrawRenderer();
+
+	if (AllocationTracker::IsEnabled() && ImGui::CollapsingHeader("Allocations"))
+		DrawAllocations();
+
+	if (ImGui::CollapsingHeader("Resources"))
+		DrawResources();
+
+	if (m_physicsSystem && ImGui::CollapsingHeader("Physics"))
+		DrawPhysics();
+
+	ImGui::End();
+}
+
+void PerformanceOverlay::SetPhysicsSystem(const PhysicsSystem* physicsSystem)
+{
+	m_physicsSystem = physicsSystem;
+}
+
+void PerformanceOverlay::SetRenderer(const SDLppRenderer* renderer)
+{
+	m_renderer = renderer;
+}
+
+void PerformanceOverlay::SetSystemScheduler(const SystemScheduler* systemScheduler)
+{
+	m_systemScheduler = systemScheduler;
+	m_systemTimes.clear();
+}
+
+void PerformanceOverlay::DrawAllocations()
+{
+#ifndef A4ENGINE_ALLOCATION_TRACKING
+	ImGui::TextDisabled("allocations are seen with the allocationtracking option (xmake f --allocationtracking=y)");
+#endif
+
+	AllocationTracker& tracker = AllocationTracker::Instance();
+	ImGui::Text("last frame: %zu allocations (%.1f KiB)", tracker.GetLastFrameAllocationCount(), tracker.GetLastFrameAllocatedBytes() / 1024.0);
+	ImGui::Text("live %.1f KiB, peak %.1f KiB", tracker.GetLiveBytes() / 1024.0, tracker.GetPeakBytes() / 1024.0);
+
+	for (const AllocationTagStats& tag : tracker.GetTagStats())
+	{
+		if (tag.lastFrameAllocationCount > 0)
+			ImGui::Text("%-32s %6zu  %10.1f KiB", tag.tag, tag.lastFrameAllocationCount, tag.lastFrameAllocatedBytes / 1024.0);
+	}
+}
+
+void PerformanceOverlay::DrawFrameTimes()
+{
+	if (m_frameCount == 0)
+		return;
+
+	// Once the ring is full, the oldest frame is the next one to be overwritten
+	std::size_t firstFrame = (m_frameCount == m_frameTimes.size()) ? m_nextFrame : 0;
+	std::copy(m_frameTimes.begin(), m_frameTimes.begin() + m_frameCount, m_sortedFrameTimes.begin());
+	std::sort(m_sortedFrameTimes.begin(), m_sortedFrameTimes.begin() + m_frameCount);
+
+	auto Percentile = [&](float percentile)
+	{
+		std::size_t rank = static_cast<std::size_t>(std::ceil(percentile * m_frameCount));
+		return m_sortedFrameTimes[std::clamp<std::size_t>(rank, 1, m_frameCount) - 1];
+	};
+
+	float p50 = Percentile(0.5f);
+	float p95 = Percentile(0.95f);
+	float p99 = Percentile(0.99f);
+	float maxTime = m_sortedFrameTimes[m_frameCount - 1];
+
+	float lastTime = m_frameTimes[(m_nextFrame + m_frameTimes.size() - 1) % m_frameTimes.size()];
+	ImGui::Text("last %.2fms (%.0f FPS) over %zu frames", lastTime, (lastTime > 0.f) ? 1000.f / lastTime : 0.f, m_frameCount);
+	ImGui::Text("p50 %.2fms  p95 %.2fms  p99 %.2fms  max %.2fms", p50, p95, p99, maxTime);
+
+	ImGui::PlotLines("##FrameTimes", m_frameTimes.data(), static_cast<int>(m_frameCount), static_cast<int>(firstFrame), "frame time (ms)", 0.f, std::max(p99 * 1.5f, 1.f), ImVec2(0.f, 80.f));
+
+	// Buckets go from 0 to the slowest frame
+	m_histogram.fill(0.f);
+	float bucketSize = std::max(maxTime, 1.f) / HistogramBucketCount;
+	for (std::size_t i = 0; i < m_frameCount; ++i)
+	{
+		std::size_t bucket = std::min(static_cast<std::size_t>(m_frameTimes[i] / bucketSize), HistogramBucketCount - 1);
+		m_histogram[bucket] += 1.f;
+	}
+
+	ImGui::PlotHistogram("##FrameHistogram", m_histogram.data(), static_cast<int>(m_histogram.size()), 0, "distribution (0 to max)", 0.f, FLT_MAX, ImVec2(0.f, 80.f));
+}
+
+void PerformanceOverlay::DrawPhysics()
+{
+	const PhysicsStats& stats = m_physicsSystem->GetStats();
+
+	ImGui::Text("step %llu", static_cast<unsigned long long>(m_physicsSystem->GetStepIndex()));
+	ImGui::Text("moved bodies: %zu", stats.movedBodyCount);
+	ImGui::Text("colliding pairs: %zu, contacts: %zu", stats.collidingPairCount, stats.contactCount);
+	ImGui::Text("dropped collision events: %zu", m_physicsSystem->GetDroppedCollisionEventCount());
+	ImGui::Text("pool capacity: %zu", m_physicsSystem->GetPoolCapacity());
+
+	if (stats.spatialHashCellCount > 0)
+		ImGui::Text("spatial hash: %d cells of %.1f", stats.spatialHashCellCount, stats.spatialHashCellSize);
+	else
+		ImGui::Text("broadphase: BB tree");
+}
+
+void PerformanceOverlay::DrawRenderer()
+{
+	// The frame being drawn isn't complete yet
+	const RendererStats& stats = m_renderer->GetLastFrameStats();
+
+	ImGui::Text("draw calls: %zu (%zu geometry, %zu copy)", stats.drawCallCount, stats.geometryCallCount, stats.copyCallCount);
+	ImGui::Text("vertices: %zu, indices: %zu", stats.vertexCount, stats.indexCount);
+	ImGui::Text("texture switches: %zu", stats.textureSwitchCount);
+	ImGui::Text("clear %.3fms, present %.3fms", stats.clearTime, stats.presentTime);
+}
+
+void PerformanceOverlay::DrawResources()
+{
+	ResourceMemoryUsage memoryUsage = ResourceManager::Instance().GetMemoryUsage();
+	ResourceText("collision geometries", memoryUsage.collisionGeometries);
+	ResourceText("models", memoryUsage.models);
+	ResourceText("sounds", memoryUsage.sounds);
+	ResourceText("textures (GPU)", memoryUsage.textures);
+
+	if (FrameArena::IsEnabled())
+	{
+		FrameArena& frameArena = FrameArena::Instance();
+		ImGui::Text("frame arena: %.1f KiB used of %.1f KiB (%zu threads)", frameArena.GetLastFrameUsage() / 1024.0, frameArena.GetCapacity() / 1024.0, frameArena.GetThreadCount());
+	}
+}
+
+void PerformanceOverlay::DrawSystems()
+{
+	for (std::size_t i = 0; i < m_systemTimes.size(); ++i)
+		ImGui::Text("%-32s %8.3fms", m_systemScheduler->GetSystemName(i).c_str(), m_systemTimes[i]);
+}
+
+void PerformanceOverlay::DrawZones()
+{
+	if (!Profiler::IsEnabled())
+	{
+		ImGui::TextDisabled("no Profiler");
+		return;
+	}
+
+#ifndef A4ENGINE_PROFILING
+	ImGui::TextDisabled("zones are compiled with the profiling option (xmake f --profiling=y)");
+#endif
+
+	for (const ZoneTiming& zone : m_zones)
+		ImGui::Text("%-32s %8.3fms  x%u", zone.name, zone.averageTime, zone.callCount);
+}
+
+void PerformanceOverlay::UpdateSystems()
+{
+	if (!m_systemScheduler)
+		return;
+
+	// Only grows when systems are added
+	std::size_t systemCount = m_systemScheduler->GetSystemCount();
+	if (m_systemTimes.size() != systemCount)
+		m_systemTimes.resize(systemCount, 0.f);
+
+	for (std::size_t i = 0; i < systemCount; ++i)
+		m_systemTimes[i] += (static_cast<float>(m_systemScheduler->GetSystemTime(i)) - m_systemTimes[i]) * ZoneSmoothing;
+}
+
+void PerformanceOverlay::UpdateZones()
+{
+	if (!Profiler::IsEnabled())
+		return;
+
+	Profiler& profiler = Profiler::Instance();
+
+	std::fill(m_zoneFrameTimes.begin(), m_zoneFrameTimes.end(), 0.f);
+	for (ZoneTiming& zone : m_zones)
+		zone.callCount = 0;
+
+	// Names are compared as strings, the same literal may have a different address in each module
+	std::size_t eventCount = profiler.GetEventCount();
+	for (std::size_t i = eventCount - profiler.GetLastFrameEventCount(); i < eventCount; ++i)
+	{
+		const ProfilerEvent& event = profiler.GetEvent(i);
+		auto it = std::find_if(m_zones.begin(), m_zones.end(), [&](const ZoneTiming& zone) { return std::strcmp(zone.name, event.name) == 0; });
+		if (it == m_zones.end())
+		{
+			if (m_zones.size() == MaxZoneCount)
+				continue;
+
+			it = m_zones.insert(m_zones.end(), ZoneTiming{ event.name, 0.f, 0 });
+		}
+
+		std::size_t zoneIndex = static_cast<std::size_t>(it - m_zones.begin());
+		m_zoneFrameTimes[zoneIndex] += (event.end - event.start) / 1'000'000.f;
+		it->callCount++;
+	}
+
+	for (std::size_t i = 0; i < m_zones.size(); ++i)
+		m_zones[i].averageTime += (m_zoneFrameTimes[i] - m_zones[i].averageTime) * ZoneSmoothing;
+}
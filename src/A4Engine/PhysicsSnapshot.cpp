@@ -0,0 +1,87 @@
+#include <A4Engine/PhysicsSnapshot.hpp>
+#include <cassert>
+
+PhysicsSnapshotRing::PhysicsSnapshotRing(std::size_t frameCapacity, std::size_t bodyCapacity, std::size_t contactCapacity) :
+	m_frames(frameCapacity),
+	m_firstFrame(0),
+	m_frameCount(0)
+{
+	assert(frameCapacity > 0);
+
+	for (PhysicsSnapshot& frame : m_frames)
+	{
+		frame.bodies.reserve(bodyCapacity);
+		frame.contacts.reserve(contactCapacity);
+	}
+}
+
+void PhysicsSnapshotRing::Clear()
+{
+	m_firstFrame = 0;
+	m_frameCount = 0;
+}
+
+void PhysicsSnapshotRing::DiscardAfter(std::uint64_t step)
+{
+	while (m_frameCount > 0 && GetFrame(m_frameCount - 1).step > step)
+		m_frameCount--;
+}
+
+const PhysicsSnapshot* PhysicsSnapshotRing::Find(std::uint64_t step) const
+{
+	// Rollbacks usually go a few frames back, start from the newest
+	for (std::size_t i = m_frameCount; i > 0; --i)
+	{
+		const PhysicsSnapshot& frame = GetFrame(i - 1);
+		if (frame.step == step)
+			return &frame;
+
+		if (frame.step < step)
+			break;
+	}
+
+	return nullptr;
+}
+
+std::size_t PhysicsSnapshotRing::GetFrameCapacity() const
+{
+	return m_frames.size();
+}
+
+std::size_t PhysicsSnapshotRing::GetFrameCount() const
+{
+	return m_frameCount;
+}
+
+const PhysicsSnapshot& PhysicsSnapshotRing::GetFrame(std::size_t index) const
+{
+	assert(index < m_frameCount);
+	return m_frames[(m_firstFrame + index) % m_frames.size()];
+}
+
+std::size_t PhysicsSnapshotRing::GetMemoryUsage() const
+{
+	std::size_t memoryUsage = m_frames.size() * sizeof(PhysicsSnapshot);
+	for (const PhysicsSnapshot& frame : m_frames)
+		memoryUsage += frame.bodies.capacity() * sizeof(PhysicsBodyState) + frame.contacts.capacity() * sizeof(PhysicsContactState);
+
+	return memoryUsage;
+}
+
+PhysicsSnapshot& PhysicsSnapshotRing::Push()
+{
+	if (m_frameCount == m_frames.size())
+	{
+		m_firstFrame = (m_firstFrame + 1) % m_frames.size();
+		m_frameCount--;
+	}
+
+	PhysicsSnapshot& frame = m_frames[(m_firstFrame + m_frameCount) % m_frames.size()];
+	m_frameCount++;
+
+	// clear() keeps the capacity
+	frame.bodies.clear();
+	frame.contacts.clear();
+
+	return frame;
+}
@@ -1,27 +1,120 @@
 #include <A4Engine/PhysicsSystem.h>
 #include <entt/entt.hpp>
+#include <A4Engine/FrameArena.hpp>
+#include <A4Engine/InterpolationComponent.hpp>
+#include <A4Engine/JobSystem.hpp>
 #include <A4Engine/Math.hpp>
+#include <A4Engine/Profiler.hpp>
+#include <A4Engine/Shape.h>
 #include <A4Engine/Transform.hpp>
+#include <chipmunk/chipmunk_structs.h>
+#include <chipmunk/cpHastySpace.h>
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <tuple>
 
 
 PhysicsSystem::PhysicsSystem(entt::registry& registry) :
-	m_registry(registry)
+	PhysicsSystem(registry, PhysicsSettings{})
 {
-	m_space = cpSpaceNew();
+}
+
+PhysicsSystem::PhysicsSystem(entt::registry& registry, const PhysicsSettings& settings) :
+	m_registry(registry),
+	m_threaded(settings.threadCount != 1),
+	m_broadphase(settings.broadphase),
+	m_tunedShapeCount(0),
+	m_timeSinceTuning(0.f),
+	m_stepIndex(0),
+	m_lastTimeStep(0.f),
+	m_collisionEventCapacity(settings.collisionEventCapacity),
+	m_droppedCollisionEventCount(0),
+	m_stepping(false),
+	m_bodyPool(sizeof(cpBody)),
+	m_shapePool(std::max({ sizeof(cpCircleShape), sizeof(cpSegmentShape), sizeof(cpPolyShape) }))
+{
+	if (m_threaded)
+	{
+		m_space = cpHastySpaceNew();
+		cpHastySpaceSetThreads(m_space, settings.threadCount); //< 0 lets Chipmunk pick the core count
+	}
+	else
+		m_space = cpSpaceNew();
+
 	SetGravity(981.f);
 	SetDamping(0.5f);
+	SetIterations(settings.iterations);
+	SetSleepTimeThreshold(settings.sleepTimeThreshold);
+	SetIdleSpeedThreshold(settings.idleSpeedThreshold);
+
+	// AutoSpatialHash waits for the first step, there is nothing to tune from yet
+	if (m_broadphase == PhysicsBroadphase::SpatialHash)
+		UseSpatialHash(settings.spatialHashCellSize, settings.spatialHashCellCount);
+
+	cpSpaceSetUserData(m_space, this);
+
+	m_collisionEvents.reserve(m_collisionEventCapacity);
+
+	cpCollisionHandler* collisionHandler = cpSpaceAddDefaultCollisionHandler(m_space);
+	collisionHandler->beginFunc = &PhysicsSystem::OnCollisionBegin;
+	collisionHandler->separateFunc = &PhysicsSystem::OnCollisionSeparate;
+	if (settings.postSolveEvents)
+		collisionHandler->postSolveFunc = &PhysicsSystem::OnCollisionPostSolve;
+	collisionHandler->userData = this;
+
+	m_registry.on_construct<InterpolationComponent>().connect<&PhysicsSystem::OnInterpolationConstruct>(this);
+	m_registry.on_construct<RigidBodyComponent>().connect<&PhysicsSystem::OnRigidBodyConstruct>(this);
 }
 
 PhysicsSystem::~PhysicsSystem()
 {
-	auto RigidBodyView = m_registry.view<RigidBodyComponent>();
-	for (entt::entity entity : RigidBodyView)
+	m_registry.on_construct<InterpolationComponent>().disconnect<&PhysicsSystem::OnInterpolationConstruct>(this);
+	m_registry.on_construct<RigidBodyComponent>().disconnect<&PhysicsSystem::OnRigidBodyConstruct>(this);
+
+	// Components give their body and shapes back to the pools, which must happen before the space and pools go away
+	m_registry.clear<RigidBodyComponent>();
+
+	// Static geometry (level collisions) isn't owned by any component, whatever is still attached goes back to the pool too
+	cpBodyEachShape(cpSpaceGetStaticBody(m_space), [](cpBody* /*body*/, cpShape* shape, void* userData)
 	{
-		RigidBodyComponent& entityRigidBody = RigidBodyView.get<RigidBodyComponent>(entity);
-		entityRigidBody.CleanShapeBank(m_space);
-	}
+		static_cast<PhysicsSystem*>(userData)->DestroyShape(shape);
+	}, this);
 
-	cpSpaceFree(m_space);
+	if (m_threaded)
+		cpHastySpaceFree(m_space);
+	else
+		cpSpaceFree(m_space);
+}
+
+unsigned int PhysicsSystem::AddCollisionLayer(std::string name)
+{
+	return m_collisionLayers.AddLayer(std::move(name));
+}
+
+PhysicsBroadphase PhysicsSystem::GetBroadphase() const
+{
+	return m_broadphase;
+}
+
+const std::vector<CollisionEvent>& PhysicsSystem::GetCollisionEvents() const
+{
+	return m_collisionEvents;
+}
+
+const CollisionLayerTable& PhysicsSystem::GetCollisionLayers() const
+{
+	return m_collisionLayers;
+}
+
+std::size_t PhysicsSystem::GetDroppedCollisionEventCount() const
+{
+	return m_droppedCollisionEventCount;
+}
+
+std::size_t PhysicsSystem::GetPoolCapacity() const
+{
+	return m_bodyPool.GetCapacity() + m_shapePool.GetCapacity();
 }
 
 cpSpace* PhysicsSystem::GetSpace()
@@ -29,6 +122,16 @@ cpSpace* PhysicsSystem::GetSpace()
 	return m_space;
 }
 
+const PhysicsStats& PhysicsSystem::GetStats() const
+{
+	return m_stats;
+}
+
+std::uint64_t PhysicsSystem::GetStepIndex() const
+{
+	return m_stepIndex;
+}
+
 float PhysicsSystem::GetGravity()
 {
 	return cpSpaceGetGravity(m_space).y;
@@ -39,6 +142,29 @@ float PhysicsSystem::GetDamping()
 	return cpSpaceGetDamping(m_space);
 }
 
+float PhysicsSystem::GetIdleSpeedThreshold()
+{
+	return cpSpaceGetIdleSpeedThreshold(m_space);
+}
+
+int PhysicsSystem::GetIterations()
+{
+	return cpSpaceGetIterations(m_space);
+}
+
+float PhysicsSystem::GetSleepTimeThreshold()
+{
+	return cpSpaceGetSleepTimeThreshold(m_space);
+}
+
+unsigned int PhysicsSystem::GetThreadCount()
+{
+	if (!m_threaded)
+		return 1;
+
+	return static_cast<unsigned int>(cpHastySpaceGetThreads(m_space));
+}
+
 void PhysicsSystem::SetGravity(float value)
 {
 	cpSpaceSetGravity(m_space, cpv(0, value));
@@ -49,29 +175,698 @@ void PhysicsSystem::SetDamping(float value)
 	cpSpaceSetDamping(m_space, value);
 }
 
-void PhysicsSystem::Step(float deltaTime)
+void PhysicsSystem::SetIdleSpeedThreshold(float speed)
+{
+	cpSpaceSetIdleSpeedThreshold(m_space, speed);
+}
+
+void PhysicsSystem::SetIterations(int iterations)
+{
+	cpSpaceSetIterations(m_space, iterations);
+}
+
+void PhysicsSystem::SetLayersCollide(unsigned int firstLayer, unsigned int secondLayer, bool collide)
+{
+	m_collisionLayers.SetLayersCollide(firstLayer, secondLayer, collide);
+
+	cpSpaceEachShape(m_space, [](cpShape* shape, void* data)
+	{
+		const CollisionLayerTable& collisionLayers = *static_cast<const CollisionLayerTable*>(data);
+
+		unsigned int layer = CollisionLayerTable::GetFilterLayer(cpShapeGetFilter(shape));
+		if (layer < collisionLayers.GetLayerCount())
+			cpShapeSetFilter(shape, collisionLayers.GetFilter(layer));
+	}, &m_collisionLayers);
+}
+
+void PhysicsSystem::SetSleepTimeThreshold(float seconds)
+{
+	cpSpaceSetSleepTimeThreshold(m_space, seconds);
+}
+
+cpBody* PhysicsSystem::CreateBody(float mass, float moment)
+{
+	cpBody* body = cpBodyInit(static_cast<cpBody*>(m_bodyPool.Allocate()), mass, moment);
+	cpSpaceAddBody(m_space, body);
+
+	return body;
+}
+
+cpShape* PhysicsSystem::CreateShape(cpBody* body, const Shape& shape, unsigned int defaultLayer)
+{
+	cpShape* chipmunkShape = shape.CreateShape(body, m_shapePool.Allocate());
+
+	unsigned int layer = shape.GetCollisionLayer();
+	cpShapeSetFilter(chipmunkShape, m_collisionLayers.GetFilter((layer != Shape::BodyLayer) ? layer : defaultLayer));
+	cpSpaceAddShape(m_space, chipmunkShape);
+
+	return chipmunkShape;
+}
+
+void PhysicsSystem::DestroyBody(cpBody* body)
+{
+	cpSpaceRemoveBody(m_space, body);
+	cpBodyDestroy(body);
+	m_bodyPool.Free(body);
+}
+
+void PhysicsSystem::DestroyShape(cpShape* shape)
+{
+	cpSpaceRemoveShape(m_space, shape);
+	cpShapeDestroy(shape);
+	m_shapePool.Free(shape);
+}
+
+entt::entity PhysicsSystem::GetBodyEntity(const cpBody* body)
+{
+	// Stored + 1 so that bodies without user data (nullptr) aren't mistaken for the first entity
+	std::uintptr_t userData = reinterpret_cast<std::uintptr_t>(cpBodyGetUserData(body));
+	if (userData == 0)
+		return entt::null;
+
+	return static_cast<entt::entity>(userData - 1);
+}
+
+bool PhysicsSystem::AreQueriesThreadSafe() const
+{
+	return m_broadphase == PhysicsBroadphase::BBTree;
+}
+
+namespace
+{
+	constexpr std::size_t QueryChunkSize = 128; //< queries per job when a batch is split over the JobSystem workers
+
+	// Same test as Chipmunk's (private) cpShapeFilterReject
+	bool IsFilterRejected(const cpShapeFilter& a, const cpShapeFilter& b)
+	{
+		return (a.group != CP_NO_GROUP && a.group == b.group) || (a.categories & b.mask) == 0 || (b.categories & a.mask) == 0;
+	}
+
+	// Batches are split over the JobSystem workers when the broadphase can be read from several threads
+	template<typename F>
+	void RunQueries(bool threadSafe, std::size_t queryCount, F&& runQuery)
+	{
+		if (threadSafe)
+			JobSystem::ParallelFor(queryCount, runQuery, QueryChunkSize);
+		else
+		{
+			for (std::size_t i = 0; i < queryCount; ++i)
+				runQuery(i);
+		}
+	}
+
+	// cpSpace*Query functions lock the space (they modify it), so queries go to the spatial indices directly
+	struct BoxQueryContext
+	{
+		cpBB bb;
+		cpShapeFilter filter;
+		entt::entity* entities;
+		std::size_t entityCapacity; //< end of the part of the buffer this context fills
+		std::size_t entityCount;
+		BoxQueryResult* result;
+	};
+
+	// A body with several shapes is only reported once: the entities of the query are sorted and made unique,
+	// at its end or when the buffer is full (duplicates might be all that fills it)
+	void CompactBoxQuery(BoxQueryContext& context)
+	{
+		entt::entity* first = context.entities + context.result->first;
+		std::sort(first, context.entities + context.entityCount);
+		context.entityCount = static_cast<std::size_t>(std::unique(first, context.entities + context.entityCount) - context.entities);
+		context.result->count = context.entityCount - context.result->first;
+	}
+
+	cpCollisionID BoxQueryCallback(void* /*obj*/, void* shapePtr, cpCollisionID id, void* data)
+	{
+		BoxQueryContext& context = *static_cast<BoxQueryContext*>(data);
+		cpShape* shape = static_cast<cpShape*>(shapePtr);
+		if (cpShapeGetSensor(shape) || IsFilterRejected(context.filter, cpShapeGetFilter(shape)))
+			return id;
+
+		// The spatial hash reports every shape of the cells the box touches
+		if (!cpBBIntersects(context.bb, cpShapeGetBB(shape)))
+			return id;
+
+		if (context.entityCount >= context.entityCapacity)
+		{
+			CompactBoxQuery(context);
+			if (context.entityCount >= context.entityCapacity)
+			{
+				context.result->truncated = true;
+				return id;
+			}
+		}
+
+		context.entities[context.entityCount++] = PhysicsSystem::GetBodyEntity(cpShapeGetBody(shape));
+
+		return id;
+	}
+
+	struct PointQueryContext
+	{
+		cpShapeFilter filter;
+		cpVect position;
+		PointQueryHit* hit;
+	};
+
+	cpCollisionID PointQueryCallback(void* /*obj*/, void* shapePtr, cpCollisionID id, void* data)
+	{
+		PointQueryContext& context = *static_cast<PointQueryContext*>(data);
+		cpShape* shape = static_cast<cpShape*>(shapePtr);
+		if (cpShapeGetSensor(shape) || IsFilterRejected(context.filter, cpShapeGetFilter(shape)))
+			return id;
+
+		cpPointQueryInfo info;
+		cpFloat distance = cpShapePointQuery(shape, context.position, &info);
+		if (distance <= context.hit->distance)
+		{
+			context.hit->entity = PhysicsSystem::GetBodyEntity(cpShapeGetBody(shape));
+			context.hit->shape = shape;
+			context.hit->point = Vector2f(static_cast<float>(info.point.x), static_cast<float>(info.point.y));
+			context.hit->distance = static_cast<float>(distance);
+		}
+
+		return id;
+	}
+
+	struct RaycastContext
+	{
+		cpShapeFilter filter;
+		cpVect from;
+		cpVect to;
+		cpFloat radius;
+		RaycastHit* hit;
+	};
+
+	cpFloat RaycastCallback(void* /*obj*/, void* shapePtr, void* data)
+	{
+		RaycastContext& context = *static_cast<RaycastContext*>(data);
+		cpShape* shape = static_cast<cpShape*>(shapePtr);
+		if (cpShapeGetSensor(shape) || IsFilterRejected(context.filter, cpShapeGetFilter(shape)))
+			return context.hit->fraction;
+
+		cpSegmentQueryInfo info;
+		if (cpShapeSegmentQuery(shape, context.from, context.to, context.radius, &info) && info.alpha < context.hit->fraction)
+		{
+			context.hit->entity = PhysicsSystem::GetBodyEntity(cpShapeGetBody(shape));
+			context.hit->shape = shape;
+			context.hit->point = Vector2f(static_cast<float>(info.point.x), static_cast<float>(info.point.y));
+			context.hit->normal = Vector2f(static_cast<float>(info.normal.x), static_cast<float>(info.normal.y));
+			context.hit->fraction = static_cast<float>(info.alpha);
+		}
+
+		// The index stops looking past the closest hit so far
+		return context.hit->fraction;
+	}
+}
+
+void PhysicsSystem::QueryBoxes(const BoxQuery* queries, std::size_t queryCount, BoxQueryResult* results, entt::entity* entities, std::size_t entityCapacity, unsigned int layer) const
+{
+	cpShapeFilter filter = m_collisionLayers.GetFilter(layer);
+
+	// Split over the workers, each chunk of queries fills its own share of the entity buffer
+	std::size_t chunkCount = 1;
+	if (AreQueriesThreadSafe() && JobSystem::TryInstance() && queryCount > QueryChunkSize)
+		chunkCount = (queryCount + QueryChunkSize - 1) / QueryChunkSize;
+
+	JobSystem::ParallelFor(chunkCount, [&](std::size_t chunkIndex)
+	{
+		BoxQueryContext context;
+		context.filter = filter;
+		context.entities = entities;
+		context.entityCapacity = entityCapacity * (chunkIndex + 1) / chunkCount;
+		context.entityCount = entityCapacity * chunkIndex / chunkCount;
+
+		std::size_t lastQuery = (chunkCount > 1) ? std::min((chunkIndex + 1) * QueryChunkSize, queryCount) : queryCount;
+		for (std::size_t i = chunkIndex * QueryChunkSize; i < lastQuery; ++i)
+		{
+			results[i].first = context.entityCount;
+			results[i].count = 0;
+			results[i].truncated = false;
+			context.result = &results[i];
+
+			context.bb = cpBBNew(queries[i].min.x, queries[i].min.y, queries[i].max.x, queries[i].max.y);
+			cpSpatialIndexQuery(m_space->staticShapes, &context, context.bb, &BoxQueryCallback, &context);
+			cpSpatialIndexQuery(m_space->dynamicShapes, &context, context.bb, &BoxQueryCallback, &context);
+
+			CompactBoxQuery(context);
+		}
+	}, 1);
+}
+
+void PhysicsSystem::QueryNearestPoints(const PointQuery* queries, std::size_t queryCount, PointQueryHit* hits, unsigned int layer) const
+{
+	cpShapeFilter filter = m_collisionLayers.GetFilter(layer);
+
+	RunQueries(AreQueriesThreadSafe(), queryCount, [&](std::size_t i)
+	{
+		hits[i].entity = entt::null;
+		hits[i].shape = nullptr;
+		hits[i].point = queries[i].position;
+		hits[i].distance = queries[i].maxDistance;
+
+		PointQueryContext context;
+		context.filter = filter;
+		context.position = cpv(queries[i].position.x, queries[i].position.y);
+		context.hit = &hits[i];
+
+		cpBB bb = cpBBNewForCircle(context.position, std::max(queries[i].maxDistance, 0.f));
+		cpSpatialIndexQuery(m_space->staticShapes, &context, bb, &PointQueryCallback, &context);
+		cpSpatialIndexQuery(m_space->dynamicShapes, &context, bb, &PointQueryCallback, &context);
+	});
+}
+
+void PhysicsSystem::Raycast(const RaycastQuery* queries, std::size_t queryCount, RaycastHit* hits, unsigned int layer) const
 {
-	m_timeAccumulator += deltaTime;
-	while (m_timeAccumulator >= m_timeStep) {
-		cpSpaceStep(m_space, m_timeStep);
-		m_timeAccumulator -= m_timeStep;
+	cpShapeFilter filter = m_collisionLayers.GetFilter(layer);
+
+	RunQueries(AreQueriesThreadSafe(), queryCount, [&](std::size_t i)
+	{
+		hits[i].entity = entt::null;
+		hits[i].shape = nullptr;
+		hits[i].point = queries[i].to;
+		hits[i].normal = Vector2f(0.f, 0.f);
+		hits[i].fraction = 1.f;
+
+		RaycastContext context;
+		context.filter = filter;
+		context.from = cpv(queries[i].from.x, queries[i].from.y);
+		context.to = cpv(queries[i].to.x, queries[i].to.y);
+		context.radius = queries[i].radius;
+		context.hit = &hits[i];
+
+		cpSpatialIndexSegmentQuery(m_space->staticShapes, &context, context.from, context.to, 1.f, &RaycastCallback, &context);
+		cpSpatialIndexSegmentQuery(m_space->dynamicShapes, &context, context.from, context.to, hits[i].fraction, &RaycastCallback, &context);
+	});
+}
+
+namespace
+{
+	// FNV-1a, fed field by field (padding bytes are undefined)
+	constexpr std::uint64_t FnvOffsetBasis = 14695981039346656037ULL;
+	constexpr std::uint64_t FnvPrime = 1099511628211ULL;
+
+	template<typename T>
+	std::uint64_t HashValue(std::uint64_t hash, const T& value)
+	{
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+		{
+			hash ^= bytes[i];
+			hash *= FnvPrime;
+		}
+
+		return hash;
+	}
+
+	std::uint64_t HashBodyState(std::uint64_t hash, const PhysicsBodyState& state)
+	{
+		hash = HashValue(hash, entt::to_integral(state.entity));
+		hash = HashValue(hash, state.position.x);
+		hash = HashValue(hash, state.position.y);
+		hash = HashValue(hash, state.velocity.x);
+		hash = HashValue(hash, state.velocity.y);
+		hash = HashValue(hash, state.angle);
+		hash = HashValue(hash, state.angularVelocity);
+		hash = HashValue(hash, state.sleeping);
+
+		return hash;
+	}
+
+	bool IsContactBefore(const PhysicsContactState& lhs, const PhysicsContactState& rhs)
+	{
+		auto Key = [](const PhysicsContactState& contact)
+		{
+			return std::make_tuple(reinterpret_cast<std::uintptr_t>(contact.shapeA), reinterpret_cast<std::uintptr_t>(contact.shapeB), contact.hash);
+		};
+
+		return Key(lhs) < Key(rhs);
+	}
+
+	// Which shape is "a" can change from a step to another, the tangent (perpendicular to the a->b normal) flips with it
+	PhysicsContactState MakeContactState(const cpArbiter* arbiter, const cpContact& contact)
+	{
+		bool swapped = reinterpret_cast<std::uintptr_t>(arbiter->a) > reinterpret_cast<std::uintptr_t>(arbiter->b);
+
+		PhysicsContactState contactState;
+		contactState.shapeA = (swapped) ? arbiter->b : arbiter->a;
+		contactState.shapeB = (swapped) ? arbiter->a : arbiter->b;
+		contactState.hash = contact.hash;
+		contactState.normalImpulse = contact.jnAcc;
+		contactState.tangentImpulse = (swapped) ? -contact.jtAcc : contact.jtAcc;
+
+		return contactState;
+	}
+}
+
+void PhysicsSystem::SaveSnapshot(PhysicsSnapshot& snapshot) const
+{
+	snapshot.step = m_stepIndex;
+	snapshot.timeStep = m_lastTimeStep;
+	snapshot.hash = FnvOffsetBasis;
+	snapshot.bodies.clear();
+	snapshot.contacts.clear();
+
+	auto view = m_registry.view<RigidBodyComponent>();
+	for (entt::entity entity : view)
+	{
+		PhysicsBodyState& state = snapshot.bodies.emplace_back();
+		state.entity = entity;
+		view.get<RigidBodyComponent>(entity).SaveState(state);
+
+		snapshot.hash = HashBodyState(snapshot.hash, state);
+	}
+
+	// The next step warm starts the contacts of the pairs which touched during this one
+	for (int i = 0; i < m_space->arbiters->num; ++i)
+	{
+		const cpArbiter* arbiter = static_cast<const cpArbiter*>(m_space->arbiters->arr[i]);
+		for (int j = 0; j < arbiter->count; ++j)
+			snapshot.contacts.push_back(MakeContactState(arbiter, arbiter->contacts[j]));
+	}
+
+	std::sort(snapshot.contacts.begin(), snapshot.contacts.end(), &IsContactBefore);
+}
+
+std::size_t PhysicsSystem::RestoreSnapshot(const PhysicsSnapshot& snapshot)
+{
+	auto GetRigidBody = [&](const PhysicsBodyState& state) -> RigidBodyComponent*
+	{
+		if (!m_registry.valid(state.entity))
+			return nullptr;
+
+		// The entity may have lost its component, or got a new one since (whose body may be at the same address, the pool reuses them)
+		RigidBodyComponent* entityRigidBody = m_registry.try_get<RigidBodyComponent>(state.entity);
+		if (!entityRigidBody || entityRigidBody->GetBody() != state.body || entityRigidBody->GetSerial() != state.bodySerial)
+			return nullptr;
+
+		return entityRigidBody;
+	};
+
+	for (const PhysicsBodyState& state : snapshot.bodies)
+	{
+		RigidBodyComponent* entityRigidBody = GetRigidBody(state);
+		if (!entityRigidBody || !entityRigidBody->RestoreState(state))
+			continue;
+
+		Transform* entityTransform = m_registry.try_get<Transform>(state.entity);
+		if (!entityTransform)
+			continue;
+
+		Vector2f position(static_cast<float>(state.position.x), static_cast<float>(state.position.y));
+		float rotation = static_cast<float>(state.angle) * Rad2Deg;
+		entityTransform->SetPosition(position);
+		entityTransform->SetRotation(rotation);
+
+		// Teleport, there is nothing to interpolate from
+		if (InterpolationComponent* entityInterpolation = m_registry.try_get<InterpolationComponent>(state.entity))
+		{
+			entityInterpolation->previousPosition = position;
+			entityInterpolation->previousRotation = rotation;
+		}
+	}
+
+	for (const PhysicsBodyState& state : snapshot.bodies)
+	{
+		if (RigidBodyComponent* entityRigidBody = GetRigidBody(state))
+			entityRigidBody->RestoreSleepState(state);
+	}
+
+	// Chipmunk copies the impulses of the previous contacts with the same hash when a pair keeps touching,
+	// overwriting them makes the next step start from the same impulses as it did the first time
+	std::size_t restoredContactCount = 0;
+	for (int i = 0; i < m_space->arbiters->num; ++i)
+	{
+		cpArbiter* arbiter = static_cast<cpArbiter*>(m_space->arbiters->arr[i]);
+		for (int j = 0; j < arbiter->count; ++j)
+		{
+			cpContact& contact = arbiter->contacts[j];
+
+			PhysicsContactState key = MakeContactState(arbiter, contact);
+			auto it = std::lower_bound(snapshot.contacts.begin(), snapshot.contacts.end(), key, &IsContactBefore);
+			if (it != snapshot.contacts.end() && it->shapeA == key.shapeA && it->shapeB == key.shapeB && it->hash == key.hash)
+			{
+				contact.jnAcc = it->normalImpulse;
+				contact.jtAcc = (arbiter->a == it->shapeA) ? it->tangentImpulse : -it->tangentImpulse;
+				restoredContactCount++;
+			}
+			else
+			{
+				// Not touching at the time of the snapshot, it would have started cold
+				contact.jnAcc = 0.0;
+				contact.jtAcc = 0.0;
+			}
+		}
 	}
+
+	m_stepIndex = snapshot.step;
+	m_lastTimeStep = snapshot.timeStep;
+
+	return restoredContactCount;
 }
 
+std::uint64_t PhysicsSystem::ComputeStateHash() const
+{
+	std::uint64_t hash = FnvOffsetBasis;
+
+	PhysicsBodyState state;
+	auto view = m_registry.view<RigidBodyComponent>();
+	for (entt::entity entity : view)
+	{
+		state.entity = entity;
+		view.get<RigidBodyComponent>(entity).SaveState(state);
+
+		hash = HashBodyState(hash, state);
+	}
+
+	return hash;
+}
 
-//Tentative rate de FixedUpdate (modifications enleves)
-void PhysicsSystem::FixedUpdate(float deltaTime)
+PhysicsDeterminismReport PhysicsSystem::CheckDeterminism(const PhysicsSnapshotRing& ring)
 {
-	auto RigidBodyView = m_registry.view<RigidBodyComponent, Transform>();
-	for (entt::entity entity : RigidBodyView)
+	PhysicsDeterminismReport report;
+
+	std::size_t frameCount = ring.GetFrameCount();
+	if (frameCount < 2)
+		return report;
+
+	RestoreSnapshot(ring.GetFrame(0));
+	for (std::size_t i = 1; i < frameCount; ++i)
 	{
-		RigidBodyComponent& entityRigidBody = RigidBodyView.get<RigidBodyComponent>(entity);
-		Transform& entityTransform = RigidBodyView.get<Transform>(entity);
+		const PhysicsSnapshot& frame = ring.GetFrame(i);
+		if (frame.step != ring.GetFrame(i - 1).step + 1)
+			break;
+
+		FixedUpdate(frame.timeStep);
+		report.checkedStepCount++;
+
+		if (ComputeStateHash() != frame.hash)
+		{
+			report.firstMismatchStep = frame.step;
+			report.deterministic = false;
+			break;
+		}
+	}
+
+	RestoreSnapshot(ring.GetFrame(frameCount - 1));
+
+	return report;
+}
+
+void PhysicsSystem::UseSpatialHash(float cellSize, int cellCount)
+{
+	cpSpaceUseSpatialHash(m_space, cellSize, cellCount);
+
+	m_stats.spatialHashCellSize = cellSize;
+	m_stats.spatialHashCellCount = cellCount;
+}
+
+void PhysicsSystem::TuneSpatialHash()
+{
+	// Scratch memory, only needed until the end of the function
+	struct Sample
+	{
+		std::pmr::vector<float> extents{ FrameArena::GetResource() };
+		std::size_t shapeCount = 0;
+	};
+
+	Sample sample;
+	cpSpaceEachShape(m_space, [](cpShape* shape, void* data)
+	{
+		Sample& sample = *static_cast<Sample*>(data);
+		sample.shapeCount++;
+
+		// Level geometry (long floors, walls) would only skew the size
+		if (cpBodyGetType(cpShapeGetBody(shape)) == CP_BODY_TYPE_STATIC)
+			return;
+
+		cpBB bb = cpShapeGetBB(shape);
+		sample.extents.push_back(static_cast<float>(std::max(bb.r - bb.l, bb.t - bb.b)));
+	}, &sample);
+
+	m_tunedShapeCount = sample.shapeCount;
+	m_timeSinceTuning = 0.f;
+
+	if (sample.extents.empty())
+		return;
+
+	auto median = sample.extents.begin() + sample.extents.size() / 2;
+	std::nth_element(sample.extents.begin(), median, sample.extents.end());
+
+	UseSpatialHash(std::max(*median, 1.f), static_cast<int>(std::max<std::size_t>(1000, sample.shapeCount * 10)));
+}
+
+void PhysicsSystem::FixedUpdate(float timeStep)
+{
+	A4_PROFILE_ZONE("PhysicsSystem::FixedUpdate");
+
+	// Shapes are counted once per second of simulated time only (whatever the step rate), so idle worlds stay free
+	m_timeSinceTuning += timeStep;
+	if (m_broadphase == PhysicsBroadphase::AutoSpatialHash && (m_tunedShapeCount == 0 || m_timeSinceTuning >= 1.f))
+	{
+		m_timeSinceTuning = 0.f;
+
+		std::size_t shapeCount = 0;
+		cpSpaceEachShape(m_space, [](cpShape* /*shape*/, void* data) { (*static_cast<std::size_t*>(data))++; }, &shapeCount);
+
+		if (shapeCount > 0 && (shapeCount > m_tunedShapeCount * 2 || shapeCount < m_tunedShapeCount / 2))
+			TuneSpatialHash();
+	}
+
+	// Bodies moved by the previous step may stop now (sleep), their interpolation must not keep replaying the last move
+	for (entt::entity entity : m_movedEntities)
+	{
+		if (!m_registry.valid(entity))
+			continue;
+
+		InterpolationComponent* entityInterpolation = m_registry.try_get<InterpolationComponent>(entity);
+		Transform* entityTransform = m_registry.try_get<Transform>(entity);
+		if (!entityInterpolation || !entityTransform)
+			continue;
+
+		entityInterpolation->previousPosition = entityTransform->GetPosition();
+		entityInterpolation->previousRotation = entityTransform->GetRotation();
+	}
+	m_movedEntities.clear();
+
+	m_collisionEvents.clear();
+	m_droppedCollisionEventCount = 0;
+
+	m_stepping = true;
+	if (m_threaded)
+		cpHastySpaceStep(m_space, timeStep);
+	else
+		cpSpaceStep(m_space, timeStep);
+	m_stepping = false;
+
+	m_stepIndex++;
+	m_lastTimeStep = timeStep;
+
+	for (entt::entity entity : m_movedEntities)
+	{
+		Transform* entityTransform = m_registry.try_get<Transform>(entity);
+		if (!entityTransform)
+			continue;
+
+		RigidBodyComponent& entityRigidBody = m_registry.get<RigidBodyComponent>(entity);
+
+		// Keep the state before the step, RenderSystem interpolates from it
+		if (InterpolationComponent* entityInterpolation = m_registry.try_get<InterpolationComponent>(entity))
+		{
+			entityInterpolation->previousPosition = entityTransform->GetPosition();
+			entityInterpolation->previousRotation = entityTransform->GetRotation();
+		}
 
 		cpVect pos = entityRigidBody.GetPosition();
 		float rot = entityRigidBody.GetAngle() * Rad2Deg;
 
-		entityTransform.SetPosition(Vector2f(pos.x, pos.y));
-		entityTransform.SetRotation(rot);
+		entityTransform->SetPosition(Vector2f(pos.x, pos.y));
+		entityTransform->SetRotation(rot);
 	}
+
+	UpdateStats();
+}
+
+void PhysicsSystem::UpdateStats()
+{
+	m_stats.movedBodyCount = m_movedEntities.size();
+
+	// space->arbiters holds the pairs that were touching during the last step
+	m_stats.collidingPairCount = static_cast<std::size_t>(m_space->arbiters->num);
+	m_stats.contactCount = 0;
+	for (int i = 0; i < m_space->arbiters->num; ++i)
+		m_stats.contactCount += static_cast<std::size_t>(cpArbiterGetCount(static_cast<cpArbiter*>(m_space->arbiters->arr[i])));
+}
+
+void PhysicsSystem::PushCollisionEvent(CollisionEventType type, cpArbiter* arbiter)
+{
+	// Chipmunk also reports separations when shapes are removed, outside of the step: their entities may be half destroyed
+	if (!m_stepping)
+		return;
+
+	if (m_collisionEvents.size() >= m_collisionEventCapacity)
+	{
+		m_droppedCollisionEventCount++;
+		return;
+	}
+
+	cpBody* bodyA;
+	cpBody* bodyB;
+	cpArbiterGetBodies(arbiter, &bodyA, &bodyB);
+
+	cpVect normal = cpArbiterGetNormal(arbiter);
+	cpVect point = (cpArbiterGetCount(arbiter) > 0) ? cpArbiterGetPointA(arbiter, 0) : cpvzero;
+	cpVect impulse = (type == CollisionEventType::PostSolve) ? cpArbiterTotalImpulse(arbiter) : cpvzero;
+
+	CollisionEvent& collisionEvent = m_collisionEvents.emplace_back();
+	collisionEvent.type = type;
+	collisionEvent.entityA = GetBodyEntity(bodyA);
+	collisionEvent.entityB = GetBodyEntity(bodyB);
+	collisionEvent.normal = Vector2f(static_cast<float>(normal.x), static_cast<float>(normal.y));
+	collisionEvent.point = Vector2f(static_cast<float>(point.x), static_cast<float>(point.y));
+	collisionEvent.impulse = Vector2f(static_cast<float>(impulse.x), static_cast<float>(impulse.y));
+}
+
+cpBool PhysicsSystem::OnCollisionBegin(cpArbiter* arbiter, cpSpace* /*space*/, cpDataPointer userData)
+{
+	static_cast<PhysicsSystem*>(userData)->PushCollisionEvent(CollisionEventType::Begin, arbiter);
+	return cpTrue;
+}
+
+void PhysicsSystem::OnCollisionPostSolve(cpArbiter* arbiter, cpSpace* /*space*/, cpDataPointer userData)
+{
+	static_cast<PhysicsSystem*>(userData)->PushCollisionEvent(CollisionEventType::PostSolve, arbiter);
+}
+
+void PhysicsSystem::OnCollisionSeparate(cpArbiter* arbiter, cpSpace* /*space*/, cpDataPointer userData)
+{
+	static_cast<PhysicsSystem*>(userData)->PushCollisionEvent(CollisionEventType::Separate, arbiter);
+}
+
+void PhysicsSystem::OnInterpolationConstruct(entt::registry& registry, entt::entity entity)
+{
+	// Until its body is first moved by a step (never if it sleeps), the entity must be drawn where it is
+	const Transform* entityTransform = registry.try_get<Transform>(entity);
+	if (!entityTransform)
+		return;
+
+	InterpolationComponent& entityInterpolation = registry.get<InterpolationComponent>(entity);
+	entityInterpolation.previousPosition = entityTransform->GetPosition();
+	entityInterpolation.previousRotation = entityTransform->GetRotation();
+}
+
+void PhysicsSystem::OnRigidBodyConstruct(entt::registry& registry, entt::entity entity)
+{
+	cpBody* body = registry.get<RigidBodyComponent>(entity).GetBody();
+	cpBodySetUserData(body, reinterpret_cast<cpDataPointer>(static_cast<std::uintptr_t>(entt::to_integral(entity)) + 1));
+	cpBodySetPositionUpdateFunc(body, &PhysicsSystem::UpdateBodyPosition);
+}
+
+void PhysicsSystem::UpdateBodyPosition(cpBody* body, cpFloat timeStep)
+{
+	cpBodyUpdatePosition(body, timeStep);
+
+	// Chipmunk only integrates awake dynamic and kinematic bodies, always from the stepping thread (even with cpHastySpace)
+	PhysicsSystem* physicsSystem = static_cast<PhysicsSystem*>(cpSpaceGetUserData(cpBodyGetSpace(body)));
+	physicsSystem->m_movedEntities.push_back(GetBodyEntity(body));
 }
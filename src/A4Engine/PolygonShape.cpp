@@ -0,0 +1,26 @@
+#include <A4Engine/PolygonShape.hpp>
+
+PolygonShape::PolygonShape(const std::vector<Vector2f>& vertices, float radius) :
+	m_radius(radius)
+{
+	// Converted once here so creating the Chipmunk shape doesn't allocate
+	m_vertices.reserve(vertices.size());
+	for (const Vector2f& vertex : vertices)
+		m_vertices.push_back(cpv(vertex.x, vertex.y));
+}
+
+cpShape* PolygonShape::CreateShape(cpBody* body, void* memory) const
+{
+	// Up to CP_POLY_SHAPE_INLINE_ALLOC vertices Chipmunk stores them inside the (pooled) shape, past that it allocates them itself
+	return reinterpret_cast<cpShape*>(cpPolyShapeInit(static_cast<cpPolyShape*>(memory), body, static_cast<int>(m_vertices.size()), m_vertices.data(), cpTransformIdentity, m_radius));
+}
+
+float PolygonShape::GetMoment(float mass) const
+{
+	return cpMomentForPoly(mass, static_cast<int>(m_vertices.size()), m_vertices.data(), cpvzero, m_radius);
+}
+
+std::size_t PolygonShape::GetVertexCount() const
+{
+	return m_vertices.size();
+}
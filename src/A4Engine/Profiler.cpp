@@ -0,0 +1,279 @@
+#include <A4Engine/Profiler.hpp>
+#include <A4Engine/JobSystem.hpp>
+#include <fmt/color.h>
+#include <fmt/core.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+struct ProfilerThreadBuffer
+{
+	std::unique_ptr<ProfilerEvent[]> events;
+	std::size_t mask; //< capacity - 1, the capacity is a power of two
+	std::atomic<std::size_t> head{ 0 }; //< only written by the recording thread
+	std::atomic<std::size_t> tail{ 0 }; //< only written by Collect
+	std::atomic<std::size_t> droppedCount{ 0 };
+	std::string name;
+	unsigned int threadId;
+};
+
+namespace
+{
+	// A profiler created after another one must not reuse the buffers of the previous one
+	std::atomic<std::uint64_t> s_nextGeneration{ 1 };
+
+	struct ThreadSlot
+	{
+		std::uint64_t generation = 0;
+		ProfilerThreadBuffer* buffer = nullptr;
+	};
+
+	thread_local ThreadSlot s_threadSlot;
+
+	void WriteEscaped(std::ofstream& file, const char* str)
+	{
+		constexpr char HexDigits[] = "0123456789abcdef";
+		for (; *str != '\0'; ++str)
+		{
+			unsigned char c = static_cast<unsigned char>(*str);
+			if (c < 0x20)
+			{
+				// JSON strings can't hold control characters (a newline in a thread or zone name for example)
+				const char escaped[] = { '\\', 'u', '0', '0', HexDigits[c >> 4], HexDigits[c & 0xF] };
+				file.write(escaped, sizeof(escaped));
+				continue;
+			}
+
+			if (c == '"' || c == '\\')
+				file.put('\\');
+
+			file.put(*str);
+		}
+	}
+}
+
+Profiler::Profiler(std::size_t historyCapacity, std::size_t threadEventCapacity) :
+m_history(std::max<std::size_t>(historyCapacity, 1)),
+m_mainThreadId(std::this_thread::get_id()),
+m_historyFirst(0),
+m_historyCount(0),
+m_lastFrameEventCount(0),
+m_threadEventCapacity(1),
+m_generation(s_nextGeneration.fetch_add(1, std::memory_order_relaxed))
+{
+	if (s_instance != nullptr)
+		throw std::runtime_error("only one Profiler can be created");
+
+	while (m_threadEventCapacity < threadEventCapacity)
+		m_threadEventCapacity *= 2;
+
+	m_startTime = Now();
+	m_frameStart = m_startTime;
+
+	s_instance = this;
+}
+
+Profiler::~Profiler()
+{
+	s_instance = nullptr;
+
+	if (!m_exportPath.empty())
+		ExportChromeTrace(m_exportPath);
+}
+
+void Profiler::EndFrame()
+{
+	std::uint64_t now = Now();
+	Record("Frame", m_frameStart, now);
+	m_frameStart = now;
+
+	std::lock_guard<std::mutex> lock(m_collectMutex);
+	m_lastFrameEventCount = std::min(Collect(), m_historyCount);
+}
+
+bool Profiler::ExportChromeTrace(const std::string& filepath)
+{
+	std::lock_guard<std::mutex> lock(m_collectMutex);
+	Collect();
+
+	std::ofstream file(filepath, std::ios::trunc);
+	if (!file)
+	{
+		fmt::print(stderr, fg(fmt::color::red), "failed to open trace file {}\n", filepath);
+		return false;
+	}
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	{
+		std::lock_guard<std::mutex> threadLock(m_threadMutex);
+		for (const std::unique_ptr<ProfilerThreadBuffer>& buffer : m_threadBuffers)
+			file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":\"" << buffer->name << "\"}},\n";
+	}
+
+	// Chrome wants microseconds, nanoseconds are kept as decimals
+	for (std::size_t i = 0; i < m_historyCount; ++i)
+	{
+		const ProfilerEvent& event = m_history[(m_historyFirst + i) % m_history.size()];
+
+		file << "{\"name\":\"";
+		WriteEscaped(file, event.name);
+		file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId;
+		file << ",\"ts\":" << fmt::format("{:.3f}", (event.start - m_startTime) / 1000.0);
+		file << ",\"dur\":" << fmt::format("{:.3f}", (event.end - event.start) / 1000.0) << "}";
+		file << ((i + 1 < m_historyCount) ? ",\n" : "\n");
+	}
+
+	file << "]}\n";
+
+	return file.good();
+}
+
+std::size_t Profiler::GetDroppedEventCount() const
+{
+	std::lock_guard<std::mutex> lock(m_threadMutex);
+
+	std::size_t droppedCount = 0;
+	for (const std::unique_ptr<ProfilerThreadBuffer>& buffer : m_threadBuffers)
+		droppedCount += buffer->droppedCount.load(std::memory_order_relaxed);
+
+	return droppedCount;
+}
+
+std::size_t Profiler::GetEventCount() const
+{
+	return m_historyCount;
+}
+
+const ProfilerEvent& Profiler::GetEvent(std::size_t index) const
+{
+	assert(index < m_historyCount);
+	return m_history[(m_historyFirst + index) % m_history.size()];
+}
+
+std::size_t Profiler::GetLastFrameEventCount() const
+{
+	return m_lastFrameEventCount;
+}
+
+std::string Profiler::GetThreadName(unsigned int threadId) const
+{
+	std::lock_guard<std::mutex> lock(m_threadMutex);
+	if (threadId >= m_threadBuffers.size())
+		return {};
+
+	return m_threadBuffers[threadId]->name;
+}
+
+void Profiler::Record(const char* name, std::uint64_t start, std::uint64_t end)
+{
+	ProfilerThreadBuffer& buffer = GetThreadBuffer();
+
+	std::size_t head = buffer.head.load(std::memory_order_relaxed);
+	if (head - buffer.tail.load(std::memory_order_acquire) > buffer.mask)
+	{
+		buffer.droppedCount.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	buffer.events[head & buffer.mask] = { name, start, end, buffer.threadId };
+	buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::SetExportOnExit(std::string filepath)
+{
+	m_exportPath = std::move(filepath);
+}
+
+Profiler& Profiler::Instance()
+{
+	if (s_instance == nullptr)
+		throw std::runtime_error("Profiler hasn't been instantied");
+
+	return *s_instance;
+}
+
+const char* Profiler::Intern(std::string_view name)
+{
+	if (s_instance == nullptr)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(s_instance->m_internMutex);
+	return s_instance->m_internedNames.emplace(name).first->c_str();
+}
+
+bool Profiler::IsEnabled()
+{
+	return s_instance != nullptr;
+}
+
+std::uint64_t Profiler::Now()
+{
+	return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::size_t Profiler::Collect()
+{
+	// m_collectMutex is held, a thread buffer is only emptied from here
+	std::size_t eventCount = 0;
+
+	std::lock_guard<std::mutex> lock(m_threadMutex);
+	for (const std::unique_ptr<ProfilerThreadBuffer>& buffer : m_threadBuffers)
+	{
+		std::size_t tail = buffer->tail.load(std::memory_order_relaxed);
+		std::size_t head = buffer->head.load(std::memory_order_acquire);
+		for (; tail != head; ++tail)
+		{
+			// The history overwrites its oldest events once full
+			if (m_historyCount == m_history.size())
+			{
+				m_history[m_historyFirst] = buffer->events[tail & buffer->mask];
+				m_historyFirst = (m_historyFirst + 1) % m_history.size();
+			}
+			else
+			{
+				m_history[(m_historyFirst + m_historyCount) % m_history.size()] = buffer->events[tail & buffer->mask];
+				m_historyCount++;
+			}
+		}
+
+		eventCount += head - buffer->tail.load(std::memory_order_relaxed);
+		buffer->tail.store(tail, std::memory_order_release);
+	}
+
+	return eventCount;
+}
+
+ProfilerThreadBuffer& Profiler::GetThreadBuffer()
+{
+	if (s_threadSlot.generation == m_generation)
+		return *s_threadSlot.buffer;
+
+	// First event of this thread
+	std::unique_ptr<ProfilerThreadBuffer> buffer = std::make_unique<ProfilerThreadBuffer>();
+	buffer->events = std::make_unique<ProfilerEvent[]>(m_threadEventCapacity);
+	buffer->mask = m_threadEventCapacity - 1;
+
+	unsigned int workerIndex = JobSystem::GetCurrentThreadIndex();
+	if (workerIndex > 0)
+		buffer->name = fmt::format("worker {}", workerIndex - 1);
+	else if (std::this_thread::get_id() == m_mainThreadId)
+		buffer->name = "main";
+
+	std::lock_guard<std::mutex> lock(m_threadMutex);
+	buffer->threadId = static_cast<unsigned int>(m_threadBuffers.size());
+	if (buffer->name.empty())
+		buffer->name = fmt::format("thread {}", buffer->threadId);
+
+	s_threadSlot.generation = m_generation;
+	s_threadSlot.buffer = buffer.get();
+
+	m_threadBuffers.push_back(std::move(buffer));
+
+	return *s_threadSlot.buffer;
+}
+
+Profiler* Profiler::s_instance = nullptr;
@@ -1,11 +1,17 @@
 #include <A4Engine/RenderSystem.hpp>
 #include <A4Engine/CameraComponent.hpp>
+#include <A4Engine/FrameArena.hpp>
 #include <A4Engine/GraphicsComponent.hpp>
+#include <A4Engine/InterpolationComponent.hpp>
+#include <A4Engine/Profiler.hpp>
 #include <A4Engine/Renderable.hpp>
 #include <A4Engine/Transform.hpp>
 #include <fmt/color.h>
 #include <fmt/core.h>
 #include <entt/entt.hpp>
+#include <cmath>
+#include <memory_resource>
+#include <vector>
 
 RenderSystem::RenderSystem(SDLppRenderer& renderer, entt::registry& registry) :
 m_renderer(renderer),
@@ -13,8 +19,10 @@ m_registry(registry)
 {
 }
 
-void RenderSystem::Update(float /*deltaTime*/)
+void RenderSystem::Update(float /*deltaTime*/, float interpolationAlpha)
 {
+	A4_PROFILE_ZONE("RenderSystem::Update");
+
 	// Slection de la camra
 	const Transform* cameraTransform = nullptr;
 	auto cameraView = m_registry.view<Transform, CameraComponent>();
@@ -34,14 +42,43 @@ void RenderSystem::Update(float /*deltaTime*/)
 		return;
 	}
 
+	Matrix3 cameraMatrix = Matrix3::TRS(cameraTransform->GetPosition(), cameraTransform->GetRotation(), cameraTransform->GetScale()).Invert();
+
+	// Les matrices de toutes les entits sont calcules d'abord (boucle serre sur les composants), les renderables sont dessins ensuite.
+	// La liste ne vit que le temps de la frame, elle est alloue dans la FrameArena plutt que sur le tas
+	struct DrawCommand
+	{
+		Renderable* renderable;
+		Matrix3 matrix;
+	};
+
 	auto view = m_registry.view<Transform, GraphicsComponent>();
+
+	std::pmr::vector<DrawCommand> drawCommands(FrameArena::GetResource());
+	drawCommands.reserve(view.size_hint());
+
 	for (entt::entity entity : view)
 	{
 		Transform& entityTransform = view.get<Transform>(entity);
 		GraphicsComponent& entityGraphics = view.get<GraphicsComponent>(entity);
-		Matrix3 cameraMatrix = Matrix3::TRS(cameraTransform->GetPosition(), cameraTransform->GetRotation(), cameraTransform->GetScale()).Invert();
-		Matrix3 entityMatrix = Matrix3::TRS(entityTransform.GetPosition(), entityTransform.GetRotation(), entityTransform.GetScale());
-		Matrix3 matrixTransform = cameraMatrix * entityMatrix;
-		entityGraphics.renderable->Draw(m_renderer, matrixTransform);
+
+		Vector2f position = entityTransform.GetPosition();
+		float rotation = entityTransform.GetRotation();
+
+		// L'entit est dessine entre ses deux derniers pas fixes, pour ne pas saccader quand la physique tourne moins vite que l'affichage
+		if (const InterpolationComponent* entityInterpolation = m_registry.try_get<InterpolationComponent>(entity))
+		{
+			position = entityInterpolation->previousPosition + (position - entityInterpolation->previousPosition) * interpolationAlpha;
+
+			// On passe par le plus court chemin (de 350  10 on tourne de 20, pas de -340)
+			float rotationDelta = std::remainder(rotation - entityInterpolation->previousRotation, 360.f);
+			rotation = entityInterpolation->previousRotation + rotationDelta * interpolationAlpha;
+		}
+
+		Matrix3 entityMatrix = Matrix3::TRS(position, rotation, entityTransform.GetScale());
+		drawCommands.push_back({ entityGraphics.renderable.get(), cameraMatrix * entityMatrix });
 	}
+
+	for (const DrawCommand& drawCommand : drawCommands)
+		drawCommand.renderable->Draw(m_renderer, drawCommand.matrix);
 }
@@ -1,10 +1,53 @@
 #include <A4Engine/ResourceManager.hpp>
+#include <A4Engine/CollisionGeometry.hpp>
 #include <A4Engine/Model.hpp>
+#include <A4Engine/Profiler.hpp>
 #include <A4Engine/SDLppSurface.hpp>
 #include <A4Engine/SDLppTexture.hpp>
 #include <A4Engine/Sound.hpp>
+#include <filesystem>
 #include <stdexcept>
 
+namespace
+{
+	bool IsCollisionCacheUpToDate(const std::filesystem::path& assetPath, const std::filesystem::path& cachePath)
+	{
+		std::error_code error;
+		std::filesystem::file_time_type cacheTime = std::filesystem::last_write_time(cachePath, error);
+		if (error)
+			return false;
+
+		std::filesystem::file_time_type assetTime = std::filesystem::last_write_time(assetPath, error);
+		if (error)
+			return true; //< only the cache has been shipped
+
+		return cacheTime >= assetTime;
+	}
+
+	template<typename T>
+	ResourceClassUsage ComputeUsage(const std::unordered_map<std::string, std::shared_ptr<T>>& resources, const std::shared_ptr<T>& missingResource)
+	{
+		// Every failed load shares the "missing" resource, it's counted once
+		ResourceClassUsage usage;
+		for (const auto& [path, resource] : resources)
+		{
+			if (resource == missingResource)
+				continue;
+
+			usage.count++;
+			usage.memory += resource->GetMemoryUsage();
+		}
+
+		if (missingResource)
+		{
+			usage.count++;
+			usage.memory += missingResource->GetMemoryUsage();
+		}
+
+		return usage;
+	}
+}
+
 ResourceManager::ResourceManager(SDLppRenderer& renderer) :
 m_renderer(renderer)
 {
@@ -21,12 +64,65 @@ ResourceManager::~ResourceManager()
 
 void ResourceManager::Clear()
 {
+	m_missingCollisionGeometry.reset();
 	m_missingModel.reset();
 	m_missingTexture.reset();
+	m_collisionGeometries.clear();
 	m_models.clear();
 	m_textures.clear();
 }
 
+const std::shared_ptr<CollisionGeometry>& ResourceManager::GetCollisionGeometry(const std::string& assetPath)
+{
+	auto it = m_collisionGeometries.find(assetPath);
+	if (it != m_collisionGeometries.end())
+		return it->second;
+
+	A4_PROFILE_ZONE("ResourceManager::LoadCollisionGeometry");
+
+	// Building the geometry is slow (tracing a sprite outline especially), it's saved next to the asset and rebuilt when the asset is modified
+	std::filesystem::path cachePath = assetPath + ".collision";
+
+	CollisionGeometry geometry;
+	if (IsCollisionCacheUpToDate(assetPath, cachePath))
+		geometry = CollisionGeometry::LoadFromFile(cachePath);
+
+	if (!geometry.IsValid())
+	{
+		std::filesystem::path extension = std::filesystem::path(assetPath).extension();
+		if (extension == ".model" || extension == ".cmodel" || extension == ".bmodel")
+			geometry = CollisionGeometry::BuildFromModel(*GetModel(assetPath));
+		else
+			geometry = CollisionGeometry::BuildFromSurface(SDLppSurface::LoadFromFile(assetPath));
+
+		if (geometry.IsValid())
+			geometry.SaveToFile(cachePath);
+	}
+
+	if (!geometry.IsValid())
+	{
+		if (!m_missingCollisionGeometry)
+			m_missingCollisionGeometry = std::make_shared<CollisionGeometry>();
+
+		m_collisionGeometries.emplace(assetPath, m_missingCollisionGeometry);
+		return m_missingCollisionGeometry;
+	}
+
+	it = m_collisionGeometries.emplace(assetPath, std::make_shared<CollisionGeometry>(std::move(geometry))).first;
+	return it->second;
+}
+
+ResourceMemoryUsage ResourceManager::GetMemoryUsage() const
+{
+	ResourceMemoryUsage memoryUsage;
+	memoryUsage.collisionGeometries = ComputeUsage(m_collisionGeometries, m_missingCollisionGeometry);
+	memoryUsage.models = ComputeUsage(m_models, m_missingModel);
+	memoryUsage.sounds = ComputeUsage(m_sounds, m_missingSound);
+	memoryUsage.textures = ComputeUsage(m_textures, m_missingTexture);
+
+	return memoryUsage;
+}
+
 const std::shared_ptr<Model>& ResourceManager::GetModel(const std::string& modelPath)
 {
 	// Avons-nous déjà ce modèle en stock ?
@@ -35,6 +131,7 @@ const std::shared_ptr<Model>& ResourceManager::GetModel(const std::string& model
 		return it->second; // Oui, on peut le renvoyer
 
 	// Non, essayons de le charger
+	A4_PROFILE_ZONE("ResourceManager::LoadModel");
 	Model model = Model::LoadFromFile(modelPath);
 	if (!model.IsValid())
 	{
@@ -58,6 +155,7 @@ const std::shared_ptr<SDLppTexture>& ResourceManager::GetTexture(const std::stri
 		return it->second; // Oui, on peut la renvoyer
 
 	// Non, essayons de la charger
+	A4_PROFILE_ZONE("ResourceManager::LoadTexture");
 	SDLppSurface surface = SDLppSurface::LoadFromFile(texturePath);
 	if (!surface.IsValid())
 	{
@@ -99,6 +197,7 @@ const std::shared_ptr<Sound>& ResourceManager::GetSound(const char* soundPath)
 
 
 	// Non, essayons de la charger
+	A4_PROFILE_ZONE("ResourceManager::LoadSound");
 	Sound sound = Sound::LoadFromFile(soundPath);
 	if (!sound.IsValid())
 	{
@@ -150,6 +249,15 @@ void ResourceManager::Purge()
 			it = m_sounds.erase(it);
 	}
 
+	// Collision geometries
+	for (auto it = m_collisionGeometries.begin(); it != m_collisionGeometries.end(); )
+	{
+		if (it->second.use_count() > 1)
+			++it;
+		else
+			it = m_collisionGeometries.erase(it);
+	}
+
 }
 
 ResourceManager& ResourceManager::Instance()
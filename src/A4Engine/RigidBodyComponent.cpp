@@ -1,17 +1,50 @@
 #include "A4Engine/RigidBodyComponent.h"
+#include "A4Engine/PhysicsSnapshot.hpp"
+#include "A4Engine/PhysicsSystem.h"
+#include "A4Engine/Shape.h"
+#include <chipmunk/chipmunk_structs.h>
+#include <atomic>
+#include <cmath>
+#include <utility>
 
-RigidBodyComponent::RigidBodyComponent(float mass)
+namespace
+{
+	std::atomic<std::uint64_t> s_nextSerial(1);
+}
+
+RigidBodyComponent::RigidBodyComponent(PhysicsSystem& physicsSystem, float mass) :
+	m_physicsSystem(&physicsSystem),
+	m_moment(0.f),
+	m_collisionLayer(CollisionLayerTable::DefaultLayer),
+	m_serial(s_nextSerial.fetch_add(1, std::memory_order_relaxed))
+{
+	m_body = physicsSystem.CreateBody(mass, 1.f);
+}
+
+RigidBodyComponent::RigidBodyComponent(RigidBodyComponent&& rigidBody) noexcept :
+	m_physicsSystem(std::exchange(rigidBody.m_physicsSystem, nullptr)),
+	m_body(std::exchange(rigidBody.m_body, nullptr)),
+	m_moment(rigidBody.m_moment),
+	m_collisionLayer(rigidBody.m_collisionLayer),
+	m_serial(std::exchange(rigidBody.m_serial, 0))
 {
-	m_body = cpBodyNew(mass, 1);
 }
 
 RigidBodyComponent::~RigidBodyComponent()
 {
-	cpBodyFree(m_body);
+	Release();
 }
-void RigidBodyComponent::SetBody(cpBody* body)
+
+RigidBodyComponent& RigidBodyComponent::operator=(RigidBodyComponent&& rigidBody) noexcept
 {
-	m_body = std::move(body);
+	Release();
+
+	m_physicsSystem = std::exchange(rigidBody.m_physicsSystem, nullptr);
+	m_body = std::exchange(rigidBody.m_body, nullptr);
+	m_moment = rigidBody.m_moment;
+	m_collisionLayer = rigidBody.m_collisionLayer;
+	m_serial = std::exchange(rigidBody.m_serial, 0);
+	return *this;
 }
 
 cpBody* RigidBodyComponent::GetBody()
@@ -19,6 +52,16 @@ cpBody* RigidBodyComponent::GetBody()
 	return m_body;
 }
 
+unsigned int RigidBodyComponent::GetCollisionLayer() const
+{
+	return m_collisionLayer;
+}
+
+std::uint64_t RigidBodyComponent::GetSerial() const
+{
+	return m_serial;
+}
+
 cpVect RigidBodyComponent::GetPosition()
 {
 	return cpBodyGetPosition(m_body);
@@ -39,39 +82,109 @@ void RigidBodyComponent::SetAngle(float angle)
 	cpBodySetAngle(m_body, angle);
 }
 
-
-void RigidBodyComponent::SetMoment()
+void RigidBodyComponent::SetCollisionLayer(unsigned int layer)
 {
-	float tmp = 0;
-	for (const auto& shape : m_shapeBank) {
-		tmp += shape->GetMoment(cpBodyGetMass(m_body));
-	}
+	m_collisionLayer = layer;
 
-	cpBodySetMoment(m_body, tmp);
+	cpShapeFilter filter = m_physicsSystem->GetCollisionLayers().GetFilter(layer);
+	cpBodyEachShape(m_body, [](cpBody* /*body*/, cpShape* shape, void* data)
+	{
+		cpShapeSetFilter(shape, *static_cast<cpShapeFilter*>(data));
+	}, &filter);
+}
+
+void RigidBodyComponent::SetMoment(float moment)
+{
+	m_moment = moment;
+	cpBodySetMoment(m_body, moment);
 }
 
-void RigidBodyComponent::AddShape(cpSpace* space, Shape* shape)
+cpShape* RigidBodyComponent::AddShape(const Shape& shape)
 {
-	shape->CreateShape(m_body);
-	m_shapeBank.push_back(shape);
+	cpShape* chipmunkShape = m_physicsSystem->CreateShape(m_body, shape, m_collisionLayer);
 
-	cpSpaceAddShape(space, shape->GetShape());
-	cpSpaceAddBody(space, m_body);
+	SetMoment(m_moment + shape.GetMoment(cpBodyGetMass(m_body)));
 
-	SetMoment();
+	return chipmunkShape;
 }
 
-void RigidBodyComponent::RemoveShape(Shape* shape)
+void RigidBodyComponent::RemoveShape(cpShape* shape)
 {
-	m_shapeBank.erase(std::find(m_shapeBank.begin(), m_shapeBank.end(), shape));
+	m_physicsSystem->DestroyShape(shape);
 }
 
-void RigidBodyComponent::CleanShapeBank(cpSpace* space)
+void RigidBodyComponent::SaveState(PhysicsBodyState& state) const
 {
-	for(int i = 0; i < m_shapeBank.size(); ++i)
+	state.body = m_body;
+	state.bodySerial = m_serial;
+	state.position = cpBodyGetPosition(m_body);
+	state.velocity = cpBodyGetVelocity(m_body);
+	state.force = cpBodyGetForce(m_body);
+	state.angle = cpBodyGetAngle(m_body);
+	state.angularVelocity = cpBodyGetAngularVelocity(m_body);
+	state.torque = cpBodyGetTorque(m_body);
+	state.idleTime = m_body->sleeping.idleTime; //< no accessor, but it decides when the body falls asleep
+	state.sleeping = cpBodyIsSleeping(m_body);
+}
+
+bool RigidBodyComponent::RestoreState(const PhysicsBodyState& state)
+{
+	// Most bodies of a rollback window didn't move (resting, sleeping), skipping them avoids waking them up
+	cpVect position = cpBodyGetPosition(m_body);
+	cpVect velocity = cpBodyGetVelocity(m_body);
+	cpVect force = cpBodyGetForce(m_body);
+	if (position.x == state.position.x && position.y == state.position.y &&
+	    velocity.x == state.velocity.x && velocity.y == state.velocity.y &&
+	    force.x == state.force.x && force.y == state.force.y &&
+	    cpBodyGetAngle(m_body) == state.angle && cpBodyGetAngularVelocity(m_body) == state.angularVelocity &&
+	    cpBodyGetTorque(m_body) == state.torque)
+	{
+		if (!state.sleeping && cpBodyIsSleeping(m_body))
+			cpBodyActivate(m_body);
+
+		return false;
+	}
+
+	// Setters wake the body up, which is what we want before moving it
+	cpBodySetPosition(m_body, state.position);
+	cpBodySetAngle(m_body, state.angle);
+	cpBodySetVelocity(m_body, state.velocity);
+	cpBodySetAngularVelocity(m_body, state.angularVelocity);
+	cpBodySetForce(m_body, state.force);
+	cpBodySetTorque(m_body, state.torque);
+
+	// Queries run before the next step would otherwise see the shapes where they were
+	cpBodyEachShape(m_body, [](cpBody* body, cpShape* shape, void* /*data*/)
+	{
+		cpShapeUpdate(shape, body->transform);
+	}, nullptr);
+
+	return true;
+}
+
+void RigidBodyComponent::RestoreSleepState(const PhysicsBodyState& state)
+{
+	if (!state.sleeping)
 	{
-		cpSpaceRemoveShape(space, m_shapeBank[i]->GetShape());
-		cpShapeFree(m_shapeBank[i]->GetShape());
+		m_body->sleeping.idleTime = state.idleTime; //< no accessor, but it decides when the body falls asleep
+		return;
 	}
-	cpSpaceRemoveBody(space, m_body);
+
+	// The body sleeps alone: Chipmunk has no way to rebuild the group it was sleeping with
+	if (!cpBodyIsSleeping(m_body) && std::isfinite(cpSpaceGetSleepTimeThreshold(cpBodyGetSpace(m_body))))
+		cpBodySleep(m_body);
+}
+
+void RigidBodyComponent::Release()
+{
+	if (!m_body)
+		return;
+
+	cpBodyEachShape(m_body, [](cpBody* /*body*/, cpShape* shape, void* data)
+	{
+		static_cast<PhysicsSystem*>(data)->DestroyShape(shape);
+	}, m_physicsSystem);
+
+	m_physicsSystem->DestroyBody(m_body);
+	m_body = nullptr;
 }
@@ -1,9 +1,20 @@
 #include <A4Engine/SDLppRenderer.hpp>
+#include <A4Engine/Profiler.hpp>
 #include <A4Engine/SDLppTexture.hpp>
 #include <A4Engine/SDLppWindow.hpp>
 #include <SDL.h>
+#include <chrono>
 
-SDLppRenderer::SDLppRenderer(SDLppWindow& window, std::string_view rendererName, Uint32 flags)
+namespace
+{
+	float MillisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+SDLppRenderer::SDLppRenderer(SDLppWindow& window, std::string_view rendererName, Uint32 flags) :
+m_lastTexture(nullptr)
 {
 	int choosenDriver = -1;
 
@@ -20,7 +31,10 @@ SDLppRenderer::SDLppRenderer(SDLppWindow& window, std::string_view rendererName,
 	m_renderer = SDL_CreateRenderer(window.GetHandle(), choosenDriver, flags);
 }
 
-SDLppRenderer::SDLppRenderer(SDLppRenderer&& renderer) noexcept
+SDLppRenderer::SDLppRenderer(SDLppRenderer&& renderer) noexcept :
+m_frameStats(renderer.m_frameStats),
+m_lastFrameStats(renderer.m_lastFrameStats),
+m_lastTexture(renderer.m_lastTexture)
 {
 	m_renderer = renderer.m_renderer;
 	renderer.m_renderer = nullptr;
@@ -33,7 +47,16 @@ SDLppRenderer::~SDLppRenderer()
 
 void SDLppRenderer::Clear()
 {
+	A4_PROFILE_ZONE("SDLppRenderer::Clear");
+
+	auto start = std::chrono::steady_clock::now();
 	SDL_RenderClear(m_renderer);
+	m_frameStats.clearTime += MillisecondsSince(start);
+}
+
+const RendererStats& SDLppRenderer::GetFrameStats() const
+{
+	return m_frameStats;
 }
 
 SDL_Renderer* SDLppRenderer::GetHandle() const
@@ -41,33 +64,80 @@ SDL_Renderer* SDLppRenderer::GetHandle() const
 	return m_renderer;
 }
 
+const RendererStats& SDLppRenderer::GetLastFrameStats() const
+{
+	return m_lastFrameStats;
+}
+
 void SDLppRenderer::Present()
 {
+	A4_PROFILE_ZONE("SDLppRenderer::Present");
+
+	auto start = std::chrono::steady_clock::now();
 	SDL_RenderPresent(m_renderer);
+	m_frameStats.presentTime += MillisecondsSince(start);
+
+	m_lastFrameStats = m_frameStats;
+	m_frameStats = RendererStats{};
+	m_lastTexture = nullptr;
 }
 
 void SDLppRenderer::RenderCopy(const SDLppTexture& texture)
 {
+	CountDrawCall(texture.GetHandle());
+	m_frameStats.copyCallCount++;
+
 	SDL_RenderCopy(m_renderer, texture.GetHandle(), nullptr, nullptr);
 }
 
 void SDLppRenderer::RenderCopy(const SDLppTexture& texture, const SDL_Rect& dst)
 {
+	CountDrawCall(texture.GetHandle());
+	m_frameStats.copyCallCount++;
+
 	SDL_RenderCopy(m_renderer, texture.GetHandle(), nullptr, &dst);
 }
 
 void SDLppRenderer::RenderCopy(const SDLppTexture& texture, const SDL_Rect& src, const SDL_Rect& dst)
 {
+	CountDrawCall(texture.GetHandle());
+	m_frameStats.copyCallCount++;
+
 	SDL_RenderCopy(m_renderer, texture.GetHandle(), &src, &dst);
 }
 
+void SDLppRenderer::RenderGeometry(const SDLppTexture* texture, const SDL_Vertex* vertices, int vertexCount, const int* indices, int indexCount)
+{
+	SDL_Texture* textureHandle = (texture) ? texture->GetHandle() : nullptr;
+
+	CountDrawCall(textureHandle);
+	m_frameStats.geometryCallCount++;
+	m_frameStats.vertexCount += static_cast<std::size_t>(vertexCount);
+	m_frameStats.indexCount += static_cast<std::size_t>(indexCount);
+
+	SDL_RenderGeometry(m_renderer, textureHandle, vertices, vertexCount, indices, indexCount);
+}
+
 void SDLppRenderer::SetDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a)
 {
 	SDL_SetRenderDrawColor(m_renderer, r, g, b, a);
 }
 
+void SDLppRenderer::CountDrawCall(SDL_Texture* texture)
+{
+	m_frameStats.drawCallCount++;
+	if (texture != m_lastTexture)
+	{
+		m_frameStats.textureSwitchCount++;
+		m_lastTexture = texture;
+	}
+}
+
 SDLppRenderer& SDLppRenderer::operator=(SDLppRenderer&& renderer) noexcept
 {
 	std::swap(m_renderer, renderer.m_renderer);
+	std::swap(m_frameStats, renderer.m_frameStats);
+	std::swap(m_lastFrameStats, renderer.m_lastFrameStats);
+	std::swap(m_lastTexture, renderer.m_lastTexture);
 	return *this;
 }
@@ -27,6 +27,12 @@ SDL_Texture* SDLppTexture::GetHandle() const
 	return m_texture;
 }
 
+std::size_t SDLppTexture::GetMemoryUsage() const
+{
+	SDL_Rect rect = GetRect();
+	return static_cast<std::size_t>(rect.w) * static_cast<std::size_t>(rect.h) * 4;
+}
+
 SDL_Rect SDLppTexture::GetRect() const
 {
 	SDL_Rect rect;
@@ -7,13 +7,12 @@ SegmentShape::SegmentShape(cpVect a, cpVect b, float radius) :
 {
 }
 
-cpShape* SegmentShape::CreateShape(cpBody* body)
+cpShape* SegmentShape::CreateShape(cpBody* body, void* memory) const
 {
-	m_shape = cpSegmentShapeNew(body, m_a, m_b, m_radius);
-	return m_shape;
+	return reinterpret_cast<cpShape*>(cpSegmentShapeInit(static_cast<cpSegmentShape*>(memory), body, m_a, m_b, m_radius));
 }
 
-float SegmentShape::GetMoment(float mass)
+float SegmentShape::GetMoment(float mass) const
 {
 	return cpMomentForSegment(mass, m_a, m_b, m_radius);
 }
@@ -1,21 +1,11 @@
 #include "A4Engine/Shape.h"
 
-Shape::Shape() : 
-	m_shape(nullptr)
+unsigned int Shape::GetCollisionLayer() const
 {
+	return m_collisionLayer;
 }
 
-cpShape* Shape::GetShape()
+void Shape::SetCollisionLayer(unsigned int layer)
 {
-	return m_shape;
-}
-
-cpShape* Shape::CreateShape(cpBody* body)
-{
-	return nullptr;
-}
-
-float Shape::GetMoment(float mass)
-{
-	return 0.0f;
+	m_collisionLayer = layer;
 }
@@ -0,0 +1,399 @@
+#include "A4Engine/SoftwareMixer.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define A4_MIXER_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef __AVX__
+#define A4_MIXER_AVX
+#include <immintrin.h>
+#endif
+
+namespace
+{
+	constexpr std::uint64_t FixedOne = std::uint64_t(1) << 32;
+	constexpr float FixedToFloat = 1.f / 4294967296.f;
+	constexpr float HalfFixedToFloat = 1.f / 2147483648.f;
+
+	// Kernels: accumulate source samples (int16 values as floats) into an interleaved stereo float buffer
+	// gainLeft/gainRight already contain both the voice gain and the pan
+
+	void AccumulateMono(const std::int16_t* input, float* output, std::size_t frameCount, float gainLeft, float gainRight)
+	{
+		std::size_t i = 0;
+#if defined(A4_MIXER_AVX)
+		__m256 gains8 = _mm256_setr_ps(gainLeft, gainRight, gainLeft, gainRight, gainLeft, gainRight, gainLeft, gainRight);
+		for (; i + 8 <= frameCount; i += 8)
+		{
+			__m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]));
+			__m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16)); //< s0 s1 s2 s3
+			__m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16)); //< s4 s5 s6 s7
+
+			// Duplicate each sample for both channels: s0 s0 s1 s1 s2 s2 s3 s3
+			__m256 first = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_unpacklo_ps(lo, lo)), _mm_unpackhi_ps(lo, lo), 1);
+			__m256 second = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_unpacklo_ps(hi, hi)), _mm_unpackhi_ps(hi, hi), 1);
+
+			float* out = &output[i * 2];
+			_mm256_storeu_ps(out, _mm256_add_ps(_mm256_loadu_ps(out), _mm256_mul_ps(first, gains8)));
+			_mm256_storeu_ps(out + 8, _mm256_add_ps(_mm256_loadu_ps(out + 8), _mm256_mul_ps(second, gains8)));
+		}
+#endif
+#if defined(A4_MIXER_SSE2)
+		__m128 gains = _mm_setr_ps(gainLeft, gainRight, gainLeft, gainRight);
+		for (; i + 4 <= frameCount; i += 4)
+		{
+			__m128i samples = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&input[i]));
+			__m128 values = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+
+			float* out = &output[i * 2];
+			_mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(_mm_unpacklo_ps(values, values), gains)));
+			_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(_mm_unpackhi_ps(values, values), gains)));
+		}
+#endif
+		for (; i < frameCount; ++i)
+		{
+			float value = input[i];
+			output[i * 2 + 0] += value * gainLeft;
+			output[i * 2 + 1] += value * gainRight;
+		}
+	}
+
+	void AccumulateStereo(const std::int16_t* input, float* output, std::size_t frameCount, float gainLeft, float gainRight)
+	{
+		std::size_t i = 0;
+#if defined(A4_MIXER_AVX)
+		__m256 gains8 = _mm256_setr_ps(gainLeft, gainRight, gainLeft, gainRight, gainLeft, gainRight, gainLeft, gainRight);
+		for (; i + 4 <= frameCount; i += 4)
+		{
+			__m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i * 2]));
+			__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+			__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+			__m256 values = _mm256_cvtepi32_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1));
+
+			float* out = &output[i * 2];
+			_mm256_storeu_ps(out, _mm256_add_ps(_mm256_loadu_ps(out), _mm256_mul_ps(values, gains8)));
+		}
+#elif defined(A4_MIXER_SSE2)
+		__m128 gains = _mm_setr_ps(gainLeft, gainRight, gainLeft, gainRight);
+		for (; i + 4 <= frameCount; i += 4)
+		{
+			__m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i * 2]));
+			__m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16)); //< L0 R0 L1 R1
+			__m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16)); //< L2 R2 L3 R3
+
+			float* out = &output[i * 2];
+			_mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_mul_ps(lo, gains)));
+			_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_mul_ps(hi, gains)));
+		}
+#endif
+		for (; i < frameCount; ++i)
+		{
+			output[i * 2 + 0] += input[i * 2 + 0] * gainLeft;
+			output[i * 2 + 1] += input[i * 2 + 1] * gainRight;
+		}
+	}
+
+	// Linear interpolation between source frames, position/step are 32.32 fixed point
+	// The caller guarantees (position + (frameCount - 1) * step) >> 32 + 1 is a valid source frame
+	void AccumulateResampled(const std::int16_t* input, unsigned int channelCount, std::uint64_t position, std::uint64_t step, float* output, std::size_t frameCount, float gainLeft, float gainRight)
+	{
+		auto Sample = [&](std::uint64_t pos, unsigned int channel)
+		{
+			std::size_t index = static_cast<std::size_t>(pos >> 32) * channelCount + channel;
+			float frac = static_cast<float>(static_cast<std::uint32_t>(pos)) * FixedToFloat;
+			float a = input[index];
+			float b = input[index + channelCount];
+			return a + (b - a) * frac;
+		};
+
+		std::size_t i = 0;
+#if defined(A4_MIXER_SSE2)
+		__m128 left = _mm_set1_ps(gainLeft);
+		__m128 right = _mm_set1_ps(gainRight);
+		__m128 fracScale = _mm_set1_ps(HalfFixedToFloat);
+		unsigned int rightChannel = (channelCount == 2) ? 1 : 0;
+		for (; i + 4 <= frameCount; i += 4)
+		{
+			std::uint64_t p0 = position + (i + 0) * step;
+			std::uint64_t p1 = position + (i + 1) * step;
+			std::uint64_t p2 = position + (i + 2) * step;
+			std::uint64_t p3 = position + (i + 3) * step;
+
+			std::size_t i0 = static_cast<std::size_t>(p0 >> 32) * channelCount;
+			std::size_t i1 = static_cast<std::size_t>(p1 >> 32) * channelCount;
+			std::size_t i2 = static_cast<std::size_t>(p2 >> 32) * channelCount;
+			std::size_t i3 = static_cast<std::size_t>(p3 >> 32) * channelCount;
+
+			// There is no unsigned int to float conversion in SSE2, drop the lowest bit of the fractional parts instead
+			__m128 frac = _mm_mul_ps(_mm_cvtepi32_ps(_mm_setr_epi32(
+				static_cast<int>(static_cast<std::uint32_t>(p0) >> 1),
+				static_cast<int>(static_cast<std::uint32_t>(p1) >> 1),
+				static_cast<int>(static_cast<std::uint32_t>(p2) >> 1),
+				static_cast<int>(static_cast<std::uint32_t>(p3) >> 1))), fracScale);
+
+			__m128 a = _mm_setr_ps(input[i0], input[i1], input[i2], input[i3]);
+			__m128 b = _mm_setr_ps(input[i0 + channelCount], input[i1 + channelCount], input[i2 + channelCount], input[i3 + channelCount]);
+			__m128 l = _mm_mul_ps(_mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), frac)), left);
+
+			a = _mm_setr_ps(input[i0 + rightChannel], input[i1 + rightChannel], input[i2 + rightChannel], input[i3 + rightChannel]);
+			b = _mm_setr_ps(input[i0 + channelCount + rightChannel], input[i1 + channelCount + rightChannel], input[i2 + channelCount + rightChannel], input[i3 + channelCount + rightChannel]);
+			__m128 r = _mm_mul_ps(_mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), frac)), right);
+
+			float* out = &output[i * 2];
+			_mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_unpacklo_ps(l, r)));
+			_mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_unpackhi_ps(l, r)));
+		}
+#endif
+		for (; i < frameCount; ++i)
+		{
+			std::uint64_t pos = position + i * step;
+			output[i * 2 + 0] += Sample(pos, 0) * gainLeft;
+			output[i * 2 + 1] += Sample(pos, (channelCount == 2) ? 1 : 0) * gainRight;
+		}
+	}
+
+	void ConvertToInt16(const float* input, std::int16_t* output, std::size_t sampleCount)
+	{
+		std::size_t i = 0;
+#if defined(A4_MIXER_SSE2)
+		__m128 minValue = _mm_set1_ps(-32768.f);
+		__m128 maxValue = _mm_set1_ps(32767.f);
+		for (; i + 8 <= sampleCount; i += 8)
+		{
+			// Clamp before converting, out of range floats would become INT_MIN
+			__m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&input[i]), minValue), maxValue);
+			__m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&input[i + 4]), minValue), maxValue);
+			__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&output[i]), packed);
+		}
+#endif
+		for (; i < sampleCount; ++i)
+			output[i] = static_cast<std::int16_t>(std::lrint(std::clamp(input[i], -32768.f, 32767.f)));
+	}
+}
+
+SoftwareMixer::SoftwareMixer(std::size_t voiceCount, unsigned int sampleRate, const char* wavOutputPath) :
+	m_voices(voiceCount),
+	m_mixBuffer(BlockFrameCount * 2),
+	m_output(BlockFrameCount * 2),
+	m_outputFrameCount(0),
+	m_sampleRate(sampleRate),
+	m_writeToFile(false)
+{
+	for (Voice& voice : m_voices)
+	{
+		voice.samples = nullptr;
+		voice.frameCount = 0;
+		voice.position = 0;
+		voice.step = FixedOne;
+		voice.channelCount = 1;
+		voice.sampleRate = sampleRate;
+		voice.gain = 1.f;
+		voice.pan = 0.f;
+		voice.pitch = 1.f;
+		voice.looping = false;
+		voice.playing = false;
+	}
+
+	if (wavOutputPath)
+	{
+		drwav_data_format format;
+		format.container = drwav_container_riff;
+		format.format = DR_WAVE_FORMAT_PCM;
+		format.channels = 2;
+		format.sampleRate = sampleRate;
+		format.bitsPerSample = 16;
+
+		if (drwav_init_file_write(&m_wav, wavOutputPath, &format, nullptr))
+			m_writeToFile = true;
+		else
+			std::cout << "failed to open " << wavOutputPath << " for writing" << std::endl;
+	}
+}
+
+SoftwareMixer::~SoftwareMixer()
+{
+	if (m_writeToFile)
+		drwav_uninit(&m_wav);
+}
+
+const float* SoftwareMixer::GetMixBuffer() const
+{
+	return m_mixBuffer.data();
+}
+
+const std::int16_t* SoftwareMixer::GetOutput() const
+{
+	return m_output.data();
+}
+
+std::size_t SoftwareMixer::GetOutputFrameCount() const
+{
+	return m_outputFrameCount;
+}
+
+unsigned int SoftwareMixer::GetSampleRate() const
+{
+	return m_sampleRate;
+}
+
+std::size_t SoftwareMixer::GetVoiceCount() const
+{
+	return m_voices.size();
+}
+
+std::size_t SoftwareMixer::GetVoiceOffset(std::size_t voiceIndex) const
+{
+	return static_cast<std::size_t>(m_voices[voiceIndex].position >> 32);
+}
+
+bool SoftwareMixer::IsVoicePlaying(std::size_t voiceIndex) const
+{
+	return m_voices[voiceIndex].playing;
+}
+
+void SoftwareMixer::Mix(std::size_t frameCount)
+{
+	while (frameCount > 0)
+	{
+		std::size_t blockFrameCount = std::min(frameCount, BlockFrameCount);
+		MixBlock(blockFrameCount);
+
+		frameCount -= blockFrameCount;
+	}
+}
+
+void SoftwareMixer::PlayVoice(std::size_t voiceIndex, const std::int16_t* samples, std::size_t frameCount, unsigned int channelCount, unsigned int sampleRate, bool looping)
+{
+	assert(channelCount == 1 || channelCount == 2);
+
+	Voice& voice = m_voices[voiceIndex];
+	voice.samples = samples;
+	voice.frameCount = frameCount;
+	voice.position = 0;
+	voice.channelCount = channelCount;
+	voice.sampleRate = sampleRate;
+	voice.gain = 1.f;
+	voice.pan = 0.f;
+	voice.pitch = 1.f;
+	voice.looping = looping;
+	voice.playing = (samples != nullptr && frameCount > 0);
+
+	UpdateStep(voice);
+}
+
+void SoftwareMixer::SetVoiceGain(std::size_t voiceIndex, float gain)
+{
+	m_voices[voiceIndex].gain = gain;
+}
+
+void SoftwareMixer::SetVoiceOffset(std::size_t voiceIndex, std::size_t frameOffset)
+{
+	Voice& voice = m_voices[voiceIndex];
+	voice.position = std::uint64_t(std::min(frameOffset, voice.frameCount)) << 32;
+}
+
+void SoftwareMixer::SetVoicePan(std::size_t voiceIndex, float pan)
+{
+	m_voices[voiceIndex].pan = std::clamp(pan, -1.f, 1.f);
+}
+
+void SoftwareMixer::SetVoicePitch(std::size_t voiceIndex, float pitch)
+{
+	Voice& voice = m_voices[voiceIndex];
+	voice.pitch = std::max(pitch, 0.f);
+	UpdateStep(voice);
+}
+
+void SoftwareMixer::StopVoice(std::size_t voiceIndex)
+{
+	m_voices[voiceIndex].playing = false;
+}
+
+void SoftwareMixer::MixBlock(std::size_t frameCount)
+{
+	float* mixBuffer = m_mixBuffer.data();
+	std::fill(mixBuffer, mixBuffer + frameCount * 2, 0.f);
+
+	for (Voice& voice : m_voices)
+	{
+		if (voice.playing)
+			MixVoice(voice, mixBuffer, frameCount);
+	}
+
+	ConvertToInt16(mixBuffer, m_output.data(), frameCount * 2);
+	m_outputFrameCount = frameCount;
+
+	if (m_writeToFile)
+		drwav_write_pcm_frames(&m_wav, frameCount, m_output.data());
+}
+
+void SoftwareMixer::MixVoice(Voice& voice, float* output, std::size_t frameCount)
+{
+	// Constant power would be nicer, linear pan is enough for tests and cheaper
+	float gainLeft = voice.gain * std::min(1.f, 1.f - voice.pan);
+	float gainRight = voice.gain * std::min(1.f, 1.f + voice.pan);
+
+	bool unitStep = (voice.step == FixedOne);
+
+	std::size_t mixedCount = 0;
+	while (mixedCount < frameCount)
+	{
+		// How many output frames can we produce before reaching the end of the samples?
+		std::size_t frameIndex = static_cast<std::size_t>(voice.position >> 32);
+		std::size_t availableCount = 0;
+		if (unitStep)
+		{
+			if (frameIndex < voice.frameCount)
+				availableCount = voice.frameCount - frameIndex;
+		}
+		else if (frameIndex + 1 < voice.frameCount && voice.step > 0)
+		{
+			// Interpolation reads the next frame as well, stop one frame before the end
+			std::uint64_t lastPosition = std::uint64_t(voice.frameCount - 1) << 32;
+			availableCount = static_cast<std::size_t>((lastPosition - voice.position + voice.step - 1) / voice.step);
+		}
+		else if (voice.step == 0)
+			availableCount = frameCount - mixedCount; //< pitch 0, the voice is frozen
+
+		if (availableCount == 0)
+		{
+			std::size_t loopLength = (unitStep) ? voice.frameCount : voice.frameCount - 1;
+			if (!voice.looping || loopLength == 0)
+			{
+				voice.playing = false;
+				return;
+			}
+
+			voice.position -= std::uint64_t(loopLength) << 32;
+			continue;
+		}
+
+		std::size_t count = std::min(availableCount, frameCount - mixedCount);
+		float* out = &output[mixedCount * 2];
+		if (unitStep)
+		{
+			const std::int16_t* input = &voice.samples[frameIndex * voice.channelCount];
+			if (voice.channelCount == 2)
+				AccumulateStereo(input, out, count, gainLeft, gainRight);
+			else
+				AccumulateMono(input, out, count, gainLeft, gainRight);
+		}
+		else if (voice.step > 0)
+			AccumulateResampled(voice.samples, voice.channelCount, voice.position, voice.step, out, count, gainLeft, gainRight);
+
+		voice.position += count * voice.step;
+		mixedCount += count;
+	}
+}
+
+void SoftwareMixer::UpdateStep(Voice& voice)
+{
+	double ratio = static_cast<double>(voice.sampleRate) / m_sampleRate * voice.pitch;
+	voice.step = static_cast<std::uint64_t>(ratio * FixedOne + 0.5);
+}
@@ -1,56 +1,190 @@
 #include "A4Engine/Sound.hpp"
+#include "A4Engine/AudioResampler.hpp"
+#include "A4Engine/MappedFile.hpp"
 
-Sound::Sound(const char* path)
+Sound::Sound(const void* data, std::size_t size, const char* name) :
+	m_buffer(AL_NONE),
+	m_channelCount(0),
+	m_sampleRate(0),
+	m_frameCount(0)
 {
 	drwav wav;
-	if (!drwav_init_file(&wav, path, nullptr))
+	if (!data || !drwav_init_memory(&wav, data, size, nullptr))
 	{
-		std::cout << "failed to load file" << std::endl;
+		std::cout << "failed to load file " << name << std::endl;
 		invalid = true;
-	}else if(drwav_init_file(&wav, path, nullptr))
+		return;
+	}
+
+	if (wav.channels == 0 || wav.sampleRate == 0)
 	{
-		m_samples = std::vector<std::int16_t>(wav.totalPCMFrameCount * wav.channels);
-		drwav_read_pcm_frames_s16(&wav, wav.totalPCMFrameCount, m_samples.data());
+		std::cout << "failed to load file " << name << ": invalid format" << std::endl;
+		drwav_uninit(&wav);
+		invalid = true;
+		return;
+	}
+
+	m_channelCount = wav.channels;
+	m_sampleRate = wav.sampleRate;
+	m_frameCount = static_cast<std::size_t>(wav.totalPCMFrameCount);
+
+	bool softwareBackend = SoundSystem::HasInstance() && SoundSystem::Instance().GetBackend() == AudioBackend::Software;
+	unsigned int outputRate = (SoundSystem::HasInstance()) ? SoundSystem::Instance().GetOutputSampleRate() : m_sampleRate;
 
+	// Samples already stored the way OpenAL wants them are uploaded straight from the file data, without decoding
+	std::size_t byteCount = m_frameCount * m_channelCount * sizeof(std::int16_t);
+	bool directUpload = !softwareBackend &&
+	                    wav.translatedFormatTag == DR_WAVE_FORMAT_PCM && wav.bitsPerSample == 16 &&
+	                    m_channelCount <= 2 && m_sampleRate == outputRate &&
+	                    wav.dataChunkDataPos + byteCount <= size;
+
+	if (directUpload)
+	{
 		alGenBuffers(1, &m_buffer);
-		alBufferData(m_buffer, (wav.channels == 2) ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16, m_samples.data(), m_samples.size(), 44100);
+		alBufferData(m_buffer, (m_channelCount == 2) ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16, static_cast<const std::uint8_t*>(data) + wav.dataChunkDataPos, static_cast<ALsizei>(byteCount), static_cast<ALsizei>(m_sampleRate));
+	}
+	else
+	{
+		std::vector<std::int16_t> samples(m_frameCount * m_channelCount);
+		drwav_read_pcm_frames_s16(&wav, wav.totalPCMFrameCount, samples.data());
 
-		alGenSources(1, &m_source);
-		alSourcei(m_source, AL_BUFFER, m_buffer);
+		// Playback only handles mono (positional) and stereo
+		if (m_channelCount > 2)
+		{
+			samples = AudioResampler::ConvertChannels(samples.data(), m_frameCount, m_channelCount, 2);
+			m_channelCount = 2;
+		}
 
-		drwav_uninit(&wav);
+		// Resample once to the output rate so playing the sound never has to
+		if (m_sampleRate != outputRate)
+		{
+			AudioResampler resampler(m_sampleRate, outputRate);
+			samples = resampler.Process(samples.data(), m_frameCount, m_channelCount);
+
+			m_frameCount = resampler.GetOutputFrameCount(m_frameCount);
+			m_sampleRate = outputRate;
+		}
 
-		std::cout << "Sound " << path << " loaded" << std::endl;
-		invalid = false;
+		if (softwareBackend)
+		{
+			// The software mixer reads the samples directly
+			m_samples = std::move(samples);
+		}
+		else
+		{
+			// OpenAL copies the samples into its own buffer, no need to keep them around (see StreamingSound for long files)
+			alGenBuffers(1, &m_buffer);
+			alBufferData(m_buffer, (m_channelCount == 2) ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16, samples.data(), static_cast<ALsizei>(samples.size() * sizeof(std::int16_t)), static_cast<ALsizei>(m_sampleRate));
+		}
 	}
+
+	drwav_uninit(&wav);
+
+	std::cout << "Sound " << name << " loaded" << std::endl;
+	invalid = false;
 }
 
-Sound::Sound(Sound&& sound) noexcept
+Sound::Sound(Sound&& sound) noexcept :
+	m_samples(std::move(sound.m_samples))
 {
 	m_buffer = sound.m_buffer;
-	m_source = sound.m_source;
-	m_samples = sound.m_samples;
-
+	m_channelCount = sound.m_channelCount;
+	m_sampleRate = sound.m_sampleRate;
+	m_frameCount = sound.m_frameCount;
 	invalid = sound.invalid;
+
+	sound.m_buffer = AL_NONE;
+	sound.invalid = true;
 }
 Sound::~Sound()
 {
-	alDeleteBuffers(1, &m_buffer);
+	if (m_buffer == AL_NONE && m_samples.empty())
+		return;
+
+	// OpenAL refuses to delete a buffer still attached to a source (and the mixer would read freed samples)
+	if (SoundSystem::HasInstance())
+		SoundSystem::Instance().StopSound(*this);
+
+	if (m_buffer != AL_NONE)
+		alDeleteBuffers(1, &m_buffer);
 }
 
 Sound Sound::LoadFromFile(const char* soundPath)
 {
-	return Sound(soundPath);
+	// The file is mapped rather than read, only the pages actually touched by the decoder are loaded
+	MappedFile file(soundPath);
+	if (!file.IsValid())
+		return Sound(nullptr, 0, soundPath);
+
+	return Sound(file.GetData(), file.GetSize(), soundPath);
 }
 
-void Sound::Play()
+Sound Sound::LoadFromMemory(const void* data, std::size_t size, const char* name)
 {
-	if (IsValid()) {
-		alSourcePlay(m_source);
-	}
-	else {
+	return Sound(data, size, name);
+}
+
+ALuint Sound::GetBuffer() const
+{
+	return m_buffer;
+}
+
+unsigned int Sound::GetChannelCount() const
+{
+	return m_channelCount;
+}
+
+float Sound::GetDuration() const
+{
+	if (m_sampleRate == 0)
+		return 0.f;
+
+	return static_cast<float>(m_frameCount) / m_sampleRate;
+}
+
+std::size_t Sound::GetFrameCount() const
+{
+	return m_frameCount;
+}
+
+std::size_t Sound::GetMemoryUsage() const
+{
+	std::size_t memoryUsage = m_samples.capacity() * sizeof(std::int16_t);
+	if (m_buffer != AL_NONE)
+		memoryUsage += m_frameCount * m_channelCount * sizeof(std::int16_t);
+
+	return memoryUsage;
+}
+
+unsigned int Sound::GetSampleRate() const
+{
+	return m_sampleRate;
+}
+
+const std::int16_t* Sound::GetSamples() const
+{
+	return (m_samples.empty()) ? nullptr : m_samples.data();
+}
+
+VoiceHandle Sound::Play(int priority, bool looping) const
+{
+	if (!IsValid()) {
 		std::cout << "Sound invalid" << std::endl;
+		return {};
 	}
+
+	return SoundSystem::Instance().Play(*this, priority, looping);
+}
+
+Sound& Sound::operator=(Sound&& sound) noexcept
+{
+	std::swap(m_buffer, sound.m_buffer);
+	std::swap(m_channelCount, sound.m_channelCount);
+	std::swap(m_sampleRate, sound.m_sampleRate);
+	std::swap(m_frameCount, sound.m_frameCount);
+	std::swap(m_samples, sound.m_samples);
+	std::swap(invalid, sound.invalid);
+	return *this;
 }
 
 bool Sound::IsValid() const
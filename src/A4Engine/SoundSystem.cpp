@@ -1,14 +1,68 @@
 #include "A4Engine/SoundSystem.h"
+#include "A4Engine/Sound.hpp"
+#include "A4Engine/SoftwareMixer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
-SoundSystem::SoundSystem()
+SoundSystem::SoundSystem() :
+	SoundSystem(AudioBackend::OpenAL)
 {
+}
+
+SoundSystem::SoundSystem(AudioBackend backend, const char* wavOutputPath) :
+	m_backend(backend),
+	device(nullptr),
+	context(nullptr),
+	m_playCounter(0)
+{
+	if (s_instance != nullptr)
+		throw std::runtime_error("only one SoundSystem can be created");
+
+	if (m_backend == AudioBackend::Software)
+	{
+		m_mixer = std::make_unique<SoftwareMixer>(MaxVoiceCount, SoftwareSampleRate, wavOutputPath);
+		InitVoices(MaxVoiceCount);
+
+		s_instance = this;
+		return;
+	}
+
 	device = alcOpenDevice(nullptr);
 	context = alcCreateContext(device, nullptr);
 	alcMakeContextCurrent(context);
+
+	// The device tells us how many sources it can mix at once, the pool is sized on it
+	// minus a few kept for streams, which generate their own source
+	ALCint monoSources = 0;
+	ALCint stereoSources = 0;
+	alcGetIntegerv(device, ALC_MONO_SOURCES, 1, &monoSources);
+	alcGetIntegerv(device, ALC_STEREO_SOURCES, 1, &stereoSources);
+
+	std::size_t voiceCount = static_cast<std::size_t>(monoSources + stereoSources);
+	if (voiceCount == 0)
+		voiceCount = 32 + StreamSourceCount;
+
+	voiceCount = (voiceCount > StreamSourceCount) ? voiceCount - StreamSourceCount : 1;
+
+	InitVoices(std::min(voiceCount, MaxVoiceCount));
+
+	s_instance = this;
 }
 
 SoundSystem::~SoundSystem()
 {
+	s_instance = nullptr;
+
+	if (m_backend == AudioBackend::Software)
+		return;
+
+	for (Voice& voice : m_voices)
+	{
+		alSourceStop(voice.source);
+		alDeleteSources(1, &voice.source);
+	}
+
 	alcMakeContextCurrent(nullptr);
 	alcDestroyContext(context);
 
@@ -16,6 +70,11 @@ SoundSystem::~SoundSystem()
 }
 
 
+AudioBackend SoundSystem::GetBackend() const
+{
+	return m_backend;
+}
+
 const ALCdevice& SoundSystem::GetDevice()
 {
 	return *device;
@@ -25,3 +84,299 @@ const ALCcontext& SoundSystem::GetContext()
 {
 	return *context;
 }
+
+SoftwareMixer* SoundSystem::GetMixer()
+{
+	return m_mixer.get();
+}
+
+unsigned int SoundSystem::GetOutputSampleRate() const
+{
+	if (m_backend == AudioBackend::Software)
+		return m_mixer->GetSampleRate();
+
+	ALCint frequency = 0;
+	alcGetIntegerv(device, ALC_FREQUENCY, 1, &frequency);
+	return (frequency > 0) ? static_cast<unsigned int>(frequency) : 44100;
+}
+
+std::size_t SoundSystem::GetFreeVoiceCount() const
+{
+	return m_freeVoices.size();
+}
+
+std::size_t SoundSystem::GetVoiceCount() const
+{
+	return m_voices.size();
+}
+
+float SoundSystem::GetVoiceOffset(VoiceHandle voice) const
+{
+	const Voice* voiceData = GetVoice(voice);
+	if (!voiceData)
+		return 0.f;
+
+	if (m_backend == AudioBackend::Software)
+		return static_cast<float>(m_mixer->GetVoiceOffset(voice.index)) / voiceData->sampleRate;
+
+	ALfloat offset = 0.f;
+	alGetSourcef(voiceData->source, AL_SEC_OFFSET, &offset);
+	return offset;
+}
+
+bool SoundSystem::IsPlaying(VoiceHandle voice) const
+{
+	if (!GetVoice(voice))
+		return false;
+
+	return !IsVoiceStopped(voice.index);
+}
+
+VoiceHandle SoundSystem::Play(const Sound& sound, int priority, bool looping)
+{
+	if (m_freeVoices.empty())
+		Update(); //< some voices may have finished since the last frame
+
+	std::uint32_t voiceIndex;
+	if (!m_freeVoices.empty())
+	{
+		voiceIndex = m_freeVoices.back();
+		m_freeVoices.pop_back();
+	}
+	else
+	{
+		// Every voice is busy, steal the least important one
+		voiceIndex = VoiceHandle::InvalidIndex;
+		for (std::uint32_t i = 0; i < m_voices.size(); ++i)
+		{
+			const Voice& voice = m_voices[i];
+			if (voice.priority > priority)
+				continue;
+
+			if (voiceIndex == VoiceHandle::InvalidIndex)
+			{
+				voiceIndex = i;
+				continue;
+			}
+
+			const Voice& candidate = m_voices[voiceIndex];
+			if (voice.priority < candidate.priority || (voice.priority == candidate.priority && voice.startOrder < candidate.startOrder))
+				voiceIndex = i;
+		}
+
+		if (voiceIndex == VoiceHandle::InvalidIndex)
+			return {};
+
+		StopVoice(voiceIndex);
+		m_voices[voiceIndex].generation++;
+	}
+
+	Voice& voice = m_voices[voiceIndex];
+	voice.buffer = sound.GetBuffer();
+	voice.samples = sound.GetSamples();
+	voice.sampleRate = sound.GetSampleRate();
+	voice.priority = priority;
+	voice.startOrder = m_playCounter++;
+	voice.active = true;
+
+	if (m_backend == AudioBackend::Software)
+		m_mixer->PlayVoice(voiceIndex, sound.GetSamples(), sound.GetFrameCount(), sound.GetChannelCount(), sound.GetSampleRate(), looping);
+	else
+	{
+		alSourcei(voice.source, AL_BUFFER, static_cast<ALint>(voice.buffer));
+		alSourcei(voice.source, AL_LOOPING, (looping) ? AL_TRUE : AL_FALSE);
+		alSourcef(voice.source, AL_GAIN, 1.f);
+
+		// Positions are relative to the listener and attenuation is computed by the AudioSystem, OpenAL only pans
+		alSourcei(voice.source, AL_SOURCE_RELATIVE, AL_TRUE);
+		alSourcef(voice.source, AL_ROLLOFF_FACTOR, 0.f);
+		alSource3f(voice.source, AL_POSITION, 0.f, 0.f, 0.f);
+
+		alSourcePlay(voice.source);
+	}
+
+	VoiceHandle handle;
+	handle.index = voiceIndex;
+	handle.generation = voice.generation;
+
+	return handle;
+}
+
+void SoundSystem::SetVoiceGain(VoiceHandle voice, float gain)
+{
+	const Voice* voiceData = GetVoice(voice);
+	if (!voiceData)
+		return;
+
+	if (m_backend == AudioBackend::Software)
+		m_mixer->SetVoiceGain(voice.index, gain);
+	else
+		alSourcef(voiceData->source, AL_GAIN, gain);
+}
+
+void SoundSystem::SetVoiceOffset(VoiceHandle voice, float offset)
+{
+	const Voice* voiceData = GetVoice(voice);
+	if (!voiceData)
+		return;
+
+	if (m_backend == AudioBackend::Software)
+		m_mixer->SetVoiceOffset(voice.index, static_cast<std::size_t>(offset * voiceData->sampleRate));
+	else
+		alSourcef(voiceData->source, AL_SEC_OFFSET, offset);
+}
+
+void SoundSystem::SetVoicePosition(VoiceHandle voice, float x, float y)
+{
+	const Voice* voiceData = GetVoice(voice);
+	if (!voiceData)
+		return;
+
+	if (m_backend == AudioBackend::Software)
+	{
+		// Pan from the direction of the sound, like OpenAL does
+		float distance = std::sqrt(x * x + y * y);
+		m_mixer->SetVoicePan(voice.index, (distance > 0.f) ? x / distance : 0.f);
+	}
+	else
+		alSource3f(voiceData->source, AL_POSITION, x, y, 0.f);
+}
+
+void SoundSystem::Stop(VoiceHandle voice)
+{
+	if (!GetVoice(voice))
+		return;
+
+	StopVoice(voice.index);
+	ReleaseVoice(voice.index);
+}
+
+void SoundSystem::StopSound(const Sound& sound)
+{
+	// Depending on the backend, a sound is identified either by its buffer or its samples
+	ALuint buffer = sound.GetBuffer();
+	const std::int16_t* samples = sound.GetSamples();
+
+	for (std::uint32_t i = 0; i < m_voices.size(); ++i)
+	{
+		const Voice& voice = m_voices[i];
+		if (!voice.active)
+			continue;
+
+		if ((buffer != AL_NONE && voice.buffer == buffer) || (samples && voice.samples == samples))
+		{
+			StopVoice(i);
+			ReleaseVoice(i);
+		}
+	}
+}
+
+void SoundSystem::Update()
+{
+	for (std::uint32_t i = 0; i < m_voices.size(); ++i)
+	{
+		if (m_voices[i].active && IsVoiceStopped(i))
+			ReleaseVoice(i);
+	}
+}
+
+bool SoundSystem::HasInstance()
+{
+	return s_instance != nullptr;
+}
+
+SoundSystem& SoundSystem::Instance()
+{
+	if (s_instance == nullptr)
+		throw std::runtime_error("SoundSystem hasn't been instantied");
+
+	return *s_instance;
+}
+
+auto SoundSystem::GetVoice(VoiceHandle voice) const -> const Voice*
+{
+	if (voice.index >= m_voices.size())
+		return nullptr;
+
+	const Voice& voiceData = m_voices[voice.index];
+	if (!voiceData.active || voiceData.generation != voice.generation)
+		return nullptr;
+
+	return &voiceData;
+}
+
+void SoundSystem::InitVoices(std::size_t voiceCount)
+{
+	m_voices.reserve(voiceCount);
+	m_freeVoices.reserve(voiceCount);
+	for (std::size_t i = 0; i < voiceCount; ++i)
+	{
+		ALuint source = AL_NONE;
+		if (m_backend == AudioBackend::OpenAL)
+		{
+			alGetError();
+			alGenSources(1, &source);
+			if (alGetError() != AL_NO_ERROR)
+			{
+				// The device has less sources than advertised, give some back for the streams
+				for (std::size_t j = 0; j < StreamSourceCount && m_voices.size() > 1; ++j)
+				{
+					alDeleteSources(1, &m_voices.back().source);
+					m_voices.pop_back();
+				}
+
+				break;
+			}
+		}
+
+		Voice& voice = m_voices.emplace_back();
+		voice.source = source;
+		voice.buffer = AL_NONE;
+		voice.samples = nullptr;
+		voice.sampleRate = 0;
+		voice.priority = 0;
+		voice.startOrder = 0;
+		voice.generation = 0;
+		voice.active = false;
+	}
+
+	// Free voices are popped from the back, keep the first ones first
+	for (std::size_t i = m_voices.size(); i > 0; --i)
+		m_freeVoices.push_back(static_cast<std::uint32_t>(i - 1));
+}
+
+bool SoundSystem::IsVoiceStopped(std::uint32_t voiceIndex) const
+{
+	if (m_backend == AudioBackend::Software)
+		return !m_mixer->IsVoicePlaying(voiceIndex);
+
+	ALint state;
+	alGetSourcei(m_voices[voiceIndex].source, AL_SOURCE_STATE, &state);
+	return state == AL_STOPPED;
+}
+
+void SoundSystem::ReleaseVoice(std::uint32_t voiceIndex)
+{
+	Voice& voice = m_voices[voiceIndex];
+
+	// Detach the buffer so the sound can be freed while the source stays in the pool
+	if (m_backend == AudioBackend::OpenAL)
+		alSourcei(voice.source, AL_BUFFER, AL_NONE);
+
+	voice.buffer = AL_NONE;
+	voice.samples = nullptr;
+	voice.active = false;
+	voice.generation++;
+
+	m_freeVoices.push_back(voiceIndex);
+}
+
+void SoundSystem::StopVoice(std::uint32_t voiceIndex)
+{
+	if (m_backend == AudioBackend::Software)
+		m_mixer->StopVoice(voiceIndex);
+	else
+		alSourceStop(m_voices[voiceIndex].source);
+}
+
+SoundSystem* SoundSystem::s_instance = nullptr;
@@ -1,4 +1,5 @@
 #include <A4Engine/Sprite.hpp>
+#include <A4Engine/Profiler.hpp>
 #include <A4Engine/SDLppRenderer.hpp>
 #include <A4Engine/SDLppTexture.hpp>
 #include <A4Engine/Transform.hpp>
@@ -20,6 +21,8 @@ m_height(rect.h)
 
 void Sprite::Draw(SDLppRenderer& renderer, const Matrix3& transformMatrix /*const Transform& cameraTransform, const Transform& transform*/)
 {
+	A4_PROFILE_ZONE("Sprite::Draw");
+
 	SDL_Rect texRect = m_texture->GetRect();
 
 	Vector2f originPos = m_origin * Vector2f(m_width, m_height);
@@ -78,8 +81,7 @@ void Sprite::Draw(SDLppRenderer& renderer, const Matrix3& transformMatrix /*cons
 	// Six indices pour deux triangles, avec réutilisation des sommets [1] et [2]
 	int indices[6] = { 0, 1, 2, 2, 1, 3 };
 
-	SDL_RenderGeometry(renderer.GetHandle(),
-		(m_texture) ? m_texture->GetHandle() : nullptr,
+	renderer.RenderGeometry(m_texture.get(),
 		vertices, 4,
 		indices, 6);
 }
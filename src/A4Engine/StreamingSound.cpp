@@ -0,0 +1,218 @@
+#include "A4Engine/StreamingSound.hpp"
+#include "A4Engine/AudioResampler.hpp"
+#include "A4Engine/SoundSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+StreamingSound::StreamingSound(const char* path) :
+	m_source(AL_NONE),
+	m_channelCount(0),
+	m_sampleRate(0),
+	m_looping(false),
+	m_running(false)
+{
+	invalid = true;
+
+	// The software mixer only plays fully loaded sounds
+	if (!SoundSystem::HasInstance() || SoundSystem::Instance().GetBackend() == AudioBackend::Software)
+	{
+		std::cout << "failed to open stream " << path << ": streaming requires a SoundSystem using the OpenAL backend" << std::endl;
+		return;
+	}
+
+	// Only the header is read here, samples are decoded on demand by the streaming thread
+	if (!drwav_init_file(&m_wav, path, nullptr))
+	{
+		std::cout << "failed to open stream " << path << std::endl;
+		return;
+	}
+
+	if (m_wav.channels == 0 || m_wav.sampleRate == 0)
+	{
+		std::cout << "failed to open stream " << path << ": invalid format" << std::endl;
+		drwav_uninit(&m_wav);
+		return;
+	}
+
+	// Playback only handles mono and stereo, other layouts are downmixed chunk by chunk
+	m_channelCount = std::min<unsigned int>(m_wav.channels, 2);
+	m_format = (m_channelCount == 2) ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
+	m_chunk.resize(ChunkFrameCount * m_wav.channels);
+
+	// Chunks are resampled to the output rate as they are decoded, so OpenAL never resamples them when playing
+	m_sampleRate = SoundSystem::Instance().GetOutputSampleRate();
+	if (m_wav.sampleRate != m_sampleRate)
+		m_resampler.emplace(m_wav.sampleRate, m_sampleRate);
+
+	alGetError();
+	alGenBuffers(static_cast<ALsizei>(m_buffers.size()), m_buffers.data());
+	if (alGetError() != AL_NO_ERROR)
+	{
+		std::cout << "failed to open stream " << path << ": couldn't create OpenAL buffers" << std::endl;
+		drwav_uninit(&m_wav);
+		return;
+	}
+
+	alGenSources(1, &m_source);
+	if (alGetError() != AL_NO_ERROR)
+	{
+		// Every source may already be used by the SoundSystem voices and the other streams
+		std::cout << "failed to open stream " << path << ": no OpenAL source left" << std::endl;
+		alDeleteBuffers(static_cast<ALsizei>(m_buffers.size()), m_buffers.data());
+		drwav_uninit(&m_wav);
+		return;
+	}
+
+	invalid = false;
+}
+
+StreamingSound::~StreamingSound()
+{
+	if (invalid)
+		return;
+
+	Stop();
+
+	alDeleteSources(1, &m_source);
+	alDeleteBuffers(static_cast<ALsizei>(m_buffers.size()), m_buffers.data());
+
+	drwav_uninit(&m_wav);
+}
+
+bool StreamingSound::IsPlaying() const
+{
+	return m_running;
+}
+
+bool StreamingSound::IsValid() const
+{
+	return !invalid;
+}
+
+void StreamingSound::Play()
+{
+	if (!IsValid())
+	{
+		std::cout << "Sound invalid" << std::endl;
+		return;
+	}
+
+	Stop();
+
+	drwav_seek_to_pcm_frame(&m_wav, 0);
+	m_resamplerState = {};
+
+	m_running = true;
+	m_thread = std::thread(&StreamingSound::StreamThread, this);
+}
+
+void StreamingSound::SetLooping(bool looping)
+{
+	m_looping = looping;
+}
+
+void StreamingSound::Stop()
+{
+	m_running = false;
+	if (m_thread.joinable())
+		m_thread.join();
+
+	if (IsValid())
+	{
+		alSourceStop(m_source);
+		alSourcei(m_source, AL_BUFFER, AL_NONE); //< unqueues every buffer
+	}
+}
+
+bool StreamingSound::FillBuffer(ALuint buffer)
+{
+	drwav_uint64 frameCount = drwav_read_pcm_frames_s16(&m_wav, ChunkFrameCount, m_chunk.data());
+	if (frameCount < ChunkFrameCount && m_looping)
+	{
+		drwav_seek_to_pcm_frame(&m_wav, 0);
+		frameCount += drwav_read_pcm_frames_s16(&m_wav, ChunkFrameCount - frameCount, m_chunk.data() + frameCount * m_wav.channels);
+	}
+
+	const std::int16_t* samples = m_chunk.data();
+	if (m_wav.channels > 2 && frameCount > 0)
+	{
+		m_downmixedChunk = AudioResampler::ConvertChannels(m_chunk.data(), static_cast<std::size_t>(frameCount), m_wav.channels, m_channelCount);
+		samples = m_downmixedChunk.data();
+	}
+
+	std::size_t sampleCount = static_cast<std::size_t>(frameCount) * m_channelCount;
+	if (m_resampler)
+	{
+		// The resampler keeps the end of each chunk for the next one, a looping stream is resampled across the loop point
+		m_resampledChunk.clear();
+		m_resampler->ProcessChunk(samples, static_cast<std::size_t>(frameCount), m_channelCount, m_resamplerState, m_resampledChunk);
+		if (frameCount < ChunkFrameCount && !m_looping)
+			m_resampler->Flush(m_channelCount, m_resamplerState, m_resampledChunk); //< end of file
+
+		samples = m_resampledChunk.data();
+		sampleCount = m_resampledChunk.size();
+	}
+
+	if (sampleCount == 0)
+		return false;
+
+	ALsizei byteCount = static_cast<ALsizei>(sampleCount * sizeof(std::int16_t));
+	alBufferData(buffer, m_format, samples, byteCount, static_cast<ALsizei>(m_sampleRate));
+
+	return true;
+}
+
+void StreamingSound::StreamThread()
+{
+	// Fill the whole ring before starting the source
+	std::size_t queuedCount = 0;
+	for (ALuint buffer : m_buffers)
+	{
+		if (!FillBuffer(buffer))
+			break;
+
+		alSourceQueueBuffers(m_source, 1, &buffer);
+		queuedCount++;
+	}
+
+	if (queuedCount == 0)
+	{
+		m_running = false;
+		return;
+	}
+
+	alSourcePlay(m_source);
+
+	while (m_running)
+	{
+		// Buffers OpenAL has finished playing get refilled with the next chunk and queued back
+		ALint processedCount = 0;
+		alGetSourcei(m_source, AL_BUFFERS_PROCESSED, &processedCount);
+		for (ALint i = 0; i < processedCount; ++i)
+		{
+			ALuint buffer;
+			alSourceUnqueueBuffers(m_source, 1, &buffer);
+
+			if (FillBuffer(buffer))
+				alSourceQueueBuffers(m_source, 1, &buffer);
+		}
+
+		ALint state;
+		alGetSourcei(m_source, AL_SOURCE_STATE, &state);
+		if (state != AL_PLAYING)
+		{
+			ALint remainingCount = 0;
+			alGetSourcei(m_source, AL_BUFFERS_QUEUED, &remainingCount);
+			if (remainingCount == 0)
+				break; //< end of file, everything has been played
+
+			// The source starved before we could refill it, restart it
+			alSourcePlay(m_source);
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	m_running = false;
+}
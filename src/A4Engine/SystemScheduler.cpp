@@ -0,0 +1,243 @@
+#include <A4Engine/SystemScheduler.hpp>
+#include <A4Engine/JobSystem.hpp>
+#include <A4Engine/Profiler.hpp>
+#include <fmt/core.h>
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+	double MillisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+SystemDeclaration::SystemDeclaration(SystemScheduler& scheduler, std::size_t systemIndex) :
+m_scheduler(scheduler),
+m_systemIndex(systemIndex)
+{
+}
+
+SystemDeclaration& SystemDeclaration::MainThreadOnly()
+{
+	m_scheduler.m_systems[m_systemIndex].mainThreadOnly = true;
+	return *this;
+}
+
+void SystemDeclaration::AddAccess(entt::id_type resource, std::string_view resourceName, bool write)
+{
+	m_scheduler.m_systems[m_systemIndex].accesses.push_back({ resource, resourceName, write });
+	m_scheduler.m_graphDirty = true;
+}
+
+SystemScheduler::SystemScheduler() :
+m_frameIndex(0),
+m_frameDuration(0.0),
+m_deltaTime(0.f),
+m_levelCount(0),
+m_graphDirty(false),
+m_lastRunParallel(false)
+{
+}
+
+SystemDeclaration SystemScheduler::AddSystem(std::string name, System system)
+{
+	SystemData& systemData = m_systems.emplace_back();
+	systemData.name = std::move(name);
+	systemData.zoneName = Profiler::Intern(systemData.name); //< interning every frame would allocate under the profiler lock
+	systemData.function = std::move(system);
+
+	m_graphDirty = true;
+
+	return SystemDeclaration(*this, m_systems.size() - 1);
+}
+
+std::string SystemScheduler::GetScheduleDump() const
+{
+	std::string dump = fmt::format("frame {}: {} systems over {} levels, {:.3f}ms ({})\n", m_frameIndex, m_systems.size(), m_levelCount, m_frameDuration, (m_lastRunParallel) ? "parallel" : "serial");
+
+	// Systems of a level may run concurrently, show them in the order they started
+	std::vector<std::size_t> order(m_systems.size());
+	for (std::size_t i = 0; i < order.size(); ++i)
+		order[i] = i;
+
+	std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs)
+	{
+		const SystemData& lhsSystem = m_systems[lhs];
+		const SystemData& rhsSystem = m_systems[rhs];
+		if (lhsSystem.level != rhsSystem.level)
+			return lhsSystem.level < rhsSystem.level;
+
+		return lhsSystem.startTime < rhsSystem.startTime;
+	});
+
+	for (std::size_t systemIndex : order)
+	{
+		const SystemData& system = m_systems[systemIndex];
+
+		std::string threadName = (system.threadIndex == 0) ? std::string("main") : fmt::format("worker {}", system.threadIndex - 1);
+		dump += fmt::format("  [{}] {:<24} {:<10} {:>8.3f}ms -> {:>8.3f}ms", system.level, system.name, threadName, system.startTime, system.endTime);
+
+		for (std::size_t i = 0; i < system.dependencies.size(); ++i)
+		{
+			const Dependency& dependency = system.dependencies[i];
+			dump += (i == 0) ? " after " : ", ";
+			dump += fmt::format("{} ({})", m_systems[dependency.systemIndex].name, dependency.resourceName);
+		}
+
+		dump += '\n';
+	}
+
+	return dump;
+}
+
+std::size_t SystemScheduler::GetSystemCount() const
+{
+	return m_systems.size();
+}
+
+const std::string& SystemScheduler::GetSystemName(std::size_t systemIndex) const
+{
+	assert(systemIndex < m_systems.size());
+	return m_systems[systemIndex].name;
+}
+
+double SystemScheduler::GetSystemTime(std::size_t systemIndex) const
+{
+	assert(systemIndex < m_systems.size());
+	return m_systems[systemIndex].endTime - m_systems[systemIndex].startTime;
+}
+
+void SystemScheduler::Run(float deltaTime)
+{
+	// Pools of the components viewed by the systems may not exist yet, let the first run create them on a single thread
+	bool runSerially = m_graphDirty;
+	if (m_graphDirty)
+		BuildGraph();
+
+	m_deltaTime = deltaTime;
+	m_frameIndex++;
+	m_frameStart = std::chrono::steady_clock::now();
+
+	JobSystem* jobSystem = JobSystem::TryInstance();
+	m_lastRunParallel = (jobSystem && !runSerially);
+	if (m_lastRunParallel)
+	{
+		assert(jobSystem->IsMainThread());
+
+		for (std::size_t i = 0; i < m_systems.size(); ++i)
+			m_remainingDependencies[i].store(m_systems[i].dependencies.size(), std::memory_order_relaxed);
+
+		JobCounter frameCounter;
+		for (std::size_t i = 0; i < m_systems.size(); ++i)
+		{
+			if (m_systems[i].dependencies.empty())
+				Launch(i, *jobSystem, frameCounter);
+		}
+
+		// Runs MainThreadOnly systems as they become ready
+		jobSystem->Wait(frameCounter);
+	}
+	else
+	{
+		// Dependencies always go to systems added earlier
+		for (std::size_t i = 0; i < m_systems.size(); ++i)
+			RunSystem(i);
+	}
+
+	m_frameDuration = MillisecondsSince(m_frameStart);
+}
+
+void SystemScheduler::BuildGraph()
+{
+	auto FindConflict = [](const SystemData& first, const SystemData& second) -> const Access*
+	{
+		for (const Access& firstAccess : first.accesses)
+		{
+			for (const Access& secondAccess : second.accesses)
+			{
+				if (firstAccess.resource == secondAccess.resource && (firstAccess.write || secondAccess.write))
+					return &firstAccess;
+			}
+		}
+
+		return nullptr;
+	};
+
+	for (SystemData& system : m_systems)
+	{
+		system.dependencies.clear();
+		system.dependents.clear();
+		system.level = 0;
+	}
+
+	// A conflict with a system which is already an ancestor of a dependency is ordered anyway, no edge is added for it
+	std::vector<std::vector<bool>> ancestors(m_systems.size(), std::vector<bool>(m_systems.size(), false));
+
+	m_levelCount = (m_systems.empty()) ? 0 : 1;
+	for (std::size_t i = 0; i < m_systems.size(); ++i)
+	{
+		SystemData& system = m_systems[i];
+		for (std::size_t j = i; j-- > 0;)
+		{
+			if (ancestors[i][j])
+				continue;
+
+			SystemData& previousSystem = m_systems[j];
+			if (const Access* conflict = FindConflict(previousSystem, system))
+			{
+				system.dependencies.push_back({ j, conflict->resourceName });
+				system.level = std::max(system.level, previousSystem.level + 1);
+
+				previousSystem.dependents.push_back(i);
+
+				ancestors[i][j] = true;
+				for (std::size_t k = 0; k < j; ++k)
+				{
+					if (ancestors[j][k])
+						ancestors[i][k] = true;
+				}
+			}
+		}
+
+		m_levelCount = std::max(m_levelCount, system.level + 1);
+	}
+
+	m_remainingDependencies = std::make_unique<std::atomic<std::size_t>[]>(m_systems.size());
+	m_graphDirty = false;
+}
+
+void SystemScheduler::Launch(std::size_t systemIndex, JobSystem& jobSystem, JobCounter& frameCounter)
+{
+	auto job = [this, systemIndex, &jobSystem, &frameCounter]
+	{
+		RunSystem(systemIndex);
+
+		// The last dependency to finish launches the dependent system, before our job leaves the frame counter
+		for (std::size_t dependentIndex : m_systems[systemIndex].dependents)
+		{
+			if (m_remainingDependencies[dependentIndex].fetch_sub(1, std::memory_order_acq_rel) == 1)
+				Launch(dependentIndex, jobSystem, frameCounter);
+		}
+	};
+
+	if (m_systems[systemIndex].mainThreadOnly)
+		jobSystem.ScheduleOnMainThread(std::move(job), &frameCounter);
+	else
+		jobSystem.Schedule(std::move(job), &frameCounter);
+}
+
+void SystemScheduler::RunSystem(std::size_t systemIndex)
+{
+	SystemData& system = m_systems[systemIndex];
+	system.threadIndex = JobSystem::GetCurrentThreadIndex();
+	system.startTime = MillisecondsSince(m_frameStart);
+
+	{
+		A4_PROFILE_ZONE(system.zoneName);
+		system.function(m_deltaTime);
+	}
+
+	system.endTime = MillisecondsSince(m_frameStart);
+}
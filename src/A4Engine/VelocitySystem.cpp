@@ -1,4 +1,5 @@
 #include <A4Engine/VelocitySystem.hpp>
+#include <A4Engine/JobSystem.hpp>
 #include <A4Engine/VelocityComponent.hpp>
 #include <A4Engine/Transform.hpp>
 #include <entt/entt.hpp>
@@ -11,12 +12,12 @@ m_registry(registry)
 void VelocitySystem::Update(float deltaTime)
 {
 	auto view = m_registry.view<Transform, VelocityComponent>();
-	for (entt::entity entity : view)
+	JobSystem::ParallelForEach(view, [&](entt::entity entity)
 	{
 		Transform& entityTransform = view.get<Transform>(entity);
 		VelocityComponent& entityVelocity = view.get<VelocityComponent>(entity);
 
 		entityTransform.Translate(entityVelocity.linearVel * deltaTime);
 		entityTransform.Rotate(entityVelocity.angularVel * deltaTime);
-	}
+	});
 }
@@ -1,10 +1,23 @@
 #include <iostream>
 #include <SDL.h>
+#include <A4Engine/AllocationHooks.hpp>
+#include <A4Engine/AllocationTracker.hpp>
 #include <A4Engine/AnimationSystem.hpp>
+#include <A4Engine/AudioListenerComponent.hpp>
+#include <A4Engine/AudioSourceComponent.hpp>
+#include <A4Engine/AudioSystem.hpp>
 #include <A4Engine/CameraComponent.hpp>
+#include <A4Engine/CollisionGeometry.hpp>
+#include <A4Engine/FixedStepScheduler.hpp>
+#include <A4Engine/FrameArena.hpp>
+#include <A4Engine/FrameStatsRecorder.hpp>
 #include <A4Engine/GraphicsComponent.hpp>
 #include <A4Engine/InputManager.hpp>
+#include <A4Engine/InterpolationComponent.hpp>
+#include <A4Engine/JobSystem.hpp>
 #include <A4Engine/Model.hpp>
+#include <A4Engine/PerformanceOverlay.hpp>
+#include <A4Engine/Profiler.hpp>
 #include <A4Engine/RenderSystem.hpp>
 #include <A4Engine/ResourceManager.hpp>
 #include <A4Engine/SDLpp.hpp>
@@ -12,8 +25,10 @@
 #include <A4Engine/SDLppRenderer.hpp>
 #include <A4Engine/SDLppTexture.hpp>
 #include <A4Engine/SDLppWindow.hpp>
+#include <A4Engine/SoundSystem.h>
 #include <A4Engine/Sprite.hpp>
 #include <A4Engine/SpritesheetComponent.hpp>
+#include <A4Engine/SystemScheduler.hpp>
 #include <A4Engine/Transform.hpp>
 #include <A4Engine/VelocityComponent.hpp>
 #include <A4Engine/VelocitySystem.hpp>
@@ -21,7 +36,7 @@
 #include <A4Engine/PhysicsSystem.h>
 #include <A4Engine/RigidBodyComponent.h>
 #include <A4Engine/BoxShape.hpp>
-#include <A4Engine/Shape.h>
+#include <A4Engine/SegmentShape.hpp>
 #include <entt/entt.hpp>
 #include <fmt/core.h>
 #include <imgui.h>
@@ -29,15 +44,24 @@
 #include <imgui_impl_sdlrenderer.h>
 #include "A4Engine/Matrix3.h"
 
-entt::entity CreateBox(entt::registry& registry);
+entt::entity CreateBox(entt::registry& registry, PhysicsSystem& physicsSystem, const Vector2f& position);
 entt::entity CreateCamera(entt::registry& registry);
 entt::entity CreateHouse(entt::registry& registry);
-entt::entity CreateRunner(entt::registry& registry, std::shared_ptr<Spritesheet> spritesheet);
+entt::entity CreateRunner(entt::registry& registry, PhysicsSystem& physicsSystem, std::shared_ptr<Spritesheet> spritesheet, const Vector2f& position);
 
 void EntityInspector(const char* windowName, entt::registry& registry, entt::entity entity);
 
-void HandleCameraMovement(entt::registry& registry, entt::entity camera, float deltaTime);
-void HandleRunnerMovement(entt::registry& registry, entt::entity runner, float deltaTime);
+// Actions interroges  chaque frame : leurs indices sont rcuprs une seule fois, IsActive(ActionId) n'est alors qu'un test de bit
+struct MovementActions
+{
+	ActionId down;
+	ActionId left;
+	ActionId right;
+	ActionId up;
+};
+
+void HandleCameraMovement(entt::registry& registry, entt::entity camera, const MovementActions& actions, float deltaTime);
+void HandleRunnerMovement(entt::registry& registry, entt::entity runner, const MovementActions& actions, float deltaTime);
 
 struct InputComponent
 {
@@ -71,15 +95,15 @@ void PlayerControllerSystem(entt::registry& registry)
 	}
 }
 
-void PlayerInputSystem(entt::registry& registry)
+void PlayerInputSystem(entt::registry& registry, const MovementActions& actions, ActionId jumpAction)
 {
 	auto view = registry.view<PlayerControlled, InputComponent>();
 	for (entt::entity entity : view)
 	{
 		auto& entityInput = view.get<InputComponent>(entity);
-		entityInput.left = InputManager::Instance().IsActive("MoveLeft");
-		entityInput.right = InputManager::Instance().IsActive("MoveRight");
-		entityInput.jump = InputManager::Instance().IsActive("Jump");
+		entityInput.left = InputManager::Instance().IsActive(actions.left);
+		entityInput.right = InputManager::Instance().IsActive(actions.right);
+		entityInput.jump = InputManager::Instance().IsActive(jumpAction);
 	}
 }
 
@@ -90,8 +114,13 @@ int main()
 	SDLppWindow window("MeronEngineRendu", 1280, 720);
 	SDLppRenderer renderer(window, "", SDL_RENDERER_PRESENTVSYNC);
 
+	SoundSystem soundSystem;
 	ResourceManager resourceManager(renderer);
 	InputManager inputManager;
+	AllocationTracker allocationTracker; //< ne voit les allocations qu'avec l'option allocationtracking (xmake f --allocationtracking=y)
+	Profiler profiler; //< avant le JobSystem : les workers sont arrts avant l'export de fin
+	FrameArena frameArena; //< mmoire temporaire de la frame (une arne par thread), vide  la fin de chaque frame
+	JobSystem jobSystem; //< un thread par coeur (moins le thread principal)
 
 	SDLppImGui imgui(window, renderer);
 
@@ -112,6 +141,20 @@ int main()
 	InputManager::Instance().BindKeyPressed(SDLK_UP, "CameraMoveUp");
 	InputManager::Instance().BindKeyPressed(SDLK_DOWN, "CameraMoveDown");
 
+	MovementActions playerActions;
+	playerActions.down = InputManager::Instance().GetActionId("MoveDown"_action);
+	playerActions.left = InputManager::Instance().GetActionId("MoveLeft"_action);
+	playerActions.right = InputManager::Instance().GetActionId("MoveRight"_action);
+	playerActions.up = InputManager::Instance().GetActionId("MoveUp"_action);
+
+	MovementActions cameraActions;
+	cameraActions.down = InputManager::Instance().GetActionId("CameraMoveDown"_action);
+	cameraActions.left = InputManager::Instance().GetActionId("CameraMoveLeft"_action);
+	cameraActions.right = InputManager::Instance().GetActionId("CameraMoveRight"_action);
+	cameraActions.up = InputManager::Instance().GetActionId("CameraMoveUp"_action);
+
+	ActionId jumpAction = InputManager::Instance().GetActionId("Jump"_action);
+
 	std::shared_ptr<Spritesheet> spriteSheet = std::make_shared<Spritesheet>();
 	spriteSheet->AddAnimation("idle", 5, 0.1f, Vector2i{ 0, 0 },  Vector2i{ 32, 32 });
 	spriteSheet->AddAnimation("run",  8, 0.1f, Vector2i{ 0, 32 }, Vector2i{ 32, 32 });
@@ -120,8 +163,10 @@ int main()
 	entt::registry registry;
 
 	AnimationSystem animSystem(registry);
+	AudioSystem audioSystem(registry);
 	RenderSystem renderSystem(renderer, registry);
 	VelocitySystem velocitySystem(registry);
+	PhysicsSystem physicsSystem(registry);
 
 	entt::entity cameraEntity = CreateCamera(registry);
 
@@ -129,8 +174,15 @@ int main()
 	registry.get<Transform>(house).SetPosition({ 750.f, 275.f });
 	registry.get<Transform>(house).SetScale({ 2.f, 2.f });
 
-	entt::entity runner = CreateRunner(registry, spriteSheet);
-	registry.get<Transform>(runner).SetPosition({ 300.f, 250.f });
+	// La maison est statique : ses formes (gnres depuis le modle) vont sur le body statique, places comme son Transform
+	std::vector<cpShape*> houseShapes;
+	{
+		const Transform& houseTransform = registry.get<Transform>(house);
+		for (const PolygonShape& shape : ResourceManager::Instance().GetCollisionGeometry("assets/house.model")->CreateShapes(houseTransform.GetScale(), houseTransform.GetPosition()))
+			houseShapes.push_back(physicsSystem.CreateShape(cpSpaceGetStaticBody(physicsSystem.GetSpace()), shape));
+	}
+
+	entt::entity runner = CreateRunner(registry, physicsSystem, spriteSheet, { 300.f, 250.f });
 
 
 	Uint64 lastUpdate = SDL_GetPerformanceCounter();
@@ -145,31 +197,122 @@ int main()
 			registry.get<SpritesheetComponent>(runner).PlayAnimation("idle");
 	});
 
-	//Create PhysicsSystem
-	PhysicsSystem physicsSystem = PhysicsSystem(registry);
-
-	//Create Shape for runner
-	std::shared_ptr<Shape> shapeRunner = std::make_shared<BoxShape>(128.f, 256.f);
-	registry.get<RigidBodyComponent>(runner).AddShape(physicsSystem.GetSpace(), shapeRunner.get());
 	registry.get<RigidBodyComponent>(runner).SetPosition({ 100,100 });
 
-	//Create shape for box
-	entt::entity box = CreateBox(registry);
-	std::shared_ptr<Shape> shapeBox = std::make_shared<BoxShape>(256.f, 256.f);
-	registry.get<RigidBodyComponent>(box).AddShape(physicsSystem.GetSpace(), shapeBox.get());
-	registry.get<RigidBodyComponent>(box).SetPosition({ 400,400 });
+	entt::entity box = CreateBox(registry, physicsSystem, { 400.f, 400.f });
 	
-	//Floor (not an entity -> Physique pas gre par PhysicsSystem
-	cpBody* floorBody = cpBodyNewStatic();
-
-	cpShape* floorShape = cpSegmentShapeNew(floorBody, cpv(0.f, 720.f), cpv(10'000.f, 720.f), 0.f);
-	cpSpaceAddShape(physicsSystem.GetSpace(), floorShape);
+	//Floor (not an entity -> on le dtruit nous-mme)
+	cpShape* floorShape = physicsSystem.CreateShape(cpSpaceGetStaticBody(physicsSystem.GetSpace()), SegmentShape(cpv(0.f, 720.f), cpv(10'000.f, 720.f), 0.f));
 
 
 	InputManager::Instance().BindKeyPressed(SDLK_SPACE, "Jump");
 
-	float physicsTimestep = 1.f / 50.f;
-	float physicsAccumulator = 0.f;
+	// La physique tourne  50Hz quel que soit le framerate, le rendu interpole entre deux pas
+	FixedStepScheduler fixedScheduler(1.f / 50.f);
+	fixedScheduler.AddSystem([&](float timeStep) { physicsSystem.FixedUpdate(timeStep); });
+
+	// Chaque systme dclare ce qu'il lit et crit : ceux qui n'entrent pas en conflit tournent en parallle (l'animation pendant la physique et l'audio par exemple)
+	// l'ordre d'ajout est celui dans lequel les systmes en conflit s'excutent
+	SystemScheduler systemScheduler;
+	systemScheduler.AddSystem("CameraMovement", [&](float deltaTime) { HandleCameraMovement(registry, cameraEntity, cameraActions, deltaTime); })
+		.Reads<InputManager>()
+		.Writes<Transform>();
+
+	systemScheduler.AddSystem("PlayerInput", [&](float /*deltaTime*/) { PlayerInputSystem(registry, playerActions, jumpAction); })
+		.Reads<InputManager, PlayerControlled>()
+		.Writes<InputComponent>();
+
+	systemScheduler.AddSystem("PlayerController", [&](float /*deltaTime*/) { PlayerControllerSystem(registry); })
+		.Reads<InputComponent>()
+		.Writes<RigidBodyComponent>();
+
+	systemScheduler.AddSystem("Physics", [&](float deltaTime) { fixedScheduler.Update(deltaTime); })
+		.Writes<FixedStepScheduler, RigidBodyComponent, Transform, InterpolationComponent>();
+
+	systemScheduler.AddSystem("Animation", [&](float deltaTime) { animSystem.Update(deltaTime); })
+		.Writes<SpritesheetComponent, Sprite>();
+
+	systemScheduler.AddSystem("Audio", [&](float deltaTime) { audioSystem.Update(deltaTime); })
+		.Reads<Transform, AudioListenerComponent>()
+		.Writes<AudioSourceComponent, SoundSystem>();
+
+	systemScheduler.AddSystem("Sound", [&](float /*deltaTime*/) { soundSystem.Update(); })
+		.Writes<SoundSystem>();
+
+	systemScheduler.AddSystem("Velocity", [&](float deltaTime) { velocitySystem.Update(deltaTime); })
+		.Reads<VelocityComponent>()
+		.Writes<Transform>();
+
+	// Le rendu passe par la SDL, il doit rester sur le thread principal
+	systemScheduler.AddSystem("Render", [&](float deltaTime) { renderSystem.Update(deltaTime, fixedScheduler.GetAlpha()); })
+		.Reads<CameraComponent, FixedStepScheduler, GraphicsComponent, InterpolationComponent, Sprite, Transform>()
+		.Writes<SDLppRenderer>()
+		.MainThreadOnly();
+
+	// F3 affiche le droulement de la dernire frame (niveaux, dpendances, threads et temps)
+	InputManager::Instance().BindKeyPressed(SDLK_F3, "DumpSchedule");
+	InputManager::Instance().OnAction("DumpSchedule", [&](bool pressed)
+	{
+		if (pressed)
+			fmt::print("{}", systemScheduler.GetScheduleDump());
+	});
+
+	// F4 exporte les dernires zones mesures ( ouvrir dans chrome://tracing ou ui.perfetto.dev), elles le sont aussi  la fermeture
+	// les zones ne sont compiles qu'avec l'option profiling (xmake f --profiling=y)
+#ifdef A4ENGINE_PROFILING
+	profiler.SetExportOnExit("A4Game.trace.json");
+#endif
+
+	InputManager::Instance().BindKeyPressed(SDLK_F4, "ExportTrace");
+	InputManager::Instance().OnAction("ExportTrace", [&](bool pressed)
+	{
+		if (pressed && profiler.ExportChromeTrace("A4Game.trace.json"))
+			fmt::print("trace exported to A4Game.trace.json\n");
+	});
+
+	// Temps de frame, zones du profiler, compteurs du rendu, mmoire des ressources et stats de la physique
+	PerformanceOverlay performanceOverlay;
+	performanceOverlay.SetPhysicsSystem(&physicsSystem);
+	performanceOverlay.SetRenderer(&renderer);
+	performanceOverlay.SetSystemScheduler(&systemScheduler);
+
+	// F5 dmarre/arrte l'enregistrement des stats de chaque frame dans A4Game.frames.csv (une ligne par frame, pour les tableaux de bord)
+	FrameStatsRecorder frameStatsRecorder;
+	std::size_t frameTimeColumn = frameStatsRecorder.AddColumn("frame_ms");
+	std::size_t entityCountColumn = frameStatsRecorder.AddColumn("entities");
+	std::size_t drawCallColumn = frameStatsRecorder.AddColumn("draw_calls");
+	std::size_t vertexCountColumn = frameStatsRecorder.AddColumn("vertices");
+	std::size_t textureSwitchColumn = frameStatsRecorder.AddColumn("texture_switches");
+	std::size_t resourceMemoryColumn = frameStatsRecorder.AddColumn("resource_memory_kib");
+	std::size_t allocationCountColumn = frameStatsRecorder.AddColumn("allocations");
+	std::size_t frameArenaColumn = frameStatsRecorder.AddColumn("frame_arena_kib");
+
+	std::vector<std::size_t> systemTimeColumns;
+	for (std::size_t i = 0; i < systemScheduler.GetSystemCount(); ++i)
+		systemTimeColumns.push_back(frameStatsRecorder.AddColumn(systemScheduler.GetSystemName(i) + "_ms"));
+
+	// F6 affiche les allocations par tag (zone du profiler) et les sites d'appel qui allouent le plus
+	InputManager::Instance().BindKeyPressed(SDLK_F6, "DumpAllocations");
+	InputManager::Instance().OnAction("DumpAllocations", [&](bool pressed)
+	{
+		if (pressed)
+			fmt::print("{}", allocationTracker.GetReport());
+	});
+
+	InputManager::Instance().BindKeyPressed(SDLK_F5, "RecordFrameStats");
+	InputManager::Instance().OnAction("RecordFrameStats", [&](bool pressed)
+	{
+		if (!pressed)
+			return;
+
+		if (frameStatsRecorder.IsRecording())
+		{
+			frameStatsRecorder.Stop();
+			fmt::print("frame stats recorded to A4Game.frames.csv ({} frames dropped)\n", frameStatsRecorder.GetDroppedFrameCount());
+		}
+		else if (frameStatsRecorder.Start("A4Game.frames.csv"))
+			fmt::print("recording frame stats to A4Game.frames.csv\n");
+	});
 
 	bool isOpen = true;
 	while (isOpen)
@@ -178,7 +321,10 @@ int main()
 		float deltaTime = (float) (now - lastUpdate) / SDL_GetPerformanceFrequency();
 		lastUpdate = now;
 
-		fmt::print("FPS: {}\n", 1.f / deltaTime);
+		performanceOverlay.AddFrame(deltaTime);
+
+		// Les actions appuyes/relches ne valent que pour les vnements de cette frame
+		InputManager::Instance().NewFrame();
 
 		SDL_Event event;
 		while (SDLpp::PollEvent(&event))
@@ -191,36 +337,56 @@ int main()
 			InputManager::Instance().HandleEvent(event);
 		}
 
+		// Les jobs qui ont besoin de la SDL ne peuvent s'excuter que sur le thread principal
+		jobSystem.RunMainThreadJobs();
+
 		imgui.NewFrame();
 
 		renderer.SetDrawColor(127, 0, 127, 255);
 		renderer.Clear();
 
-		HandleCameraMovement(registry, cameraEntity, deltaTime);
-
-		physicsAccumulator += deltaTime;
-		while (physicsAccumulator >= physicsTimestep)
-		{
-			cpSpaceStep(physicsSystem.GetSpace(), physicsTimestep);
-			physicsAccumulator -= physicsTimestep;
-		}
-
-		animSystem.Update(deltaTime);
-		velocitySystem.Update(deltaTime);
-		renderSystem.Update(deltaTime);
-		physicsSystem.FixedUpdate(deltaTime);
-		PlayerInputSystem(registry);
-		PlayerControllerSystem(registry);
+		systemScheduler.Run(deltaTime);
 
 		EntityInspector("Box", registry, box);
 		EntityInspector("Camera", registry, cameraEntity);
 		EntityInspector("Runner", registry, runner);
+		performanceOverlay.Draw();
 
 		imgui.Render();
 
 		renderer.Present();
+
+		profiler.EndFrame();
+		allocationTracker.EndFrame();
+
+		// Plus aucun systme ne tourne, la mmoire temporaire de la frame peut tre rutilise
+		frameArena.EndFrame();
+
+		if (frameStatsRecorder.IsRecording())
+		{
+			const RendererStats& rendererStats = renderer.GetLastFrameStats();
+			ResourceMemoryUsage memoryUsage = ResourceManager::Instance().GetMemoryUsage();
+			std::size_t resourceMemory = memoryUsage.collisionGeometries.memory + memoryUsage.models.memory + memoryUsage.sounds.memory + memoryUsage.textures.memory;
+
+			frameStatsRecorder.Set(frameTimeColumn, deltaTime * 1000.0);
+			frameStatsRecorder.Set(entityCountColumn, static_cast<double>(registry.view<Transform>().size()));
+			frameStatsRecorder.Set(drawCallColumn, static_cast<double>(rendererStats.drawCallCount));
+			frameStatsRecorder.Set(vertexCountColumn, static_cast<double>(rendererStats.vertexCount));
+			frameStatsRecorder.Set(textureSwitchColumn, static_cast<double>(rendererStats.textureSwitchCount));
+			frameStatsRecorder.Set(resourceMemoryColumn, resourceMemory / 1024.0);
+			frameStatsRecorder.Set(allocationCountColumn, static_cast<double>(allocationTracker.GetLastFrameAllocationCount()));
+			frameStatsRecorder.Set(frameArenaColumn, frameArena.GetLastFrameUsage() / 1024.0);
+
+			for (std::size_t i = 0; i < systemTimeColumns.size(); ++i)
+				frameStatsRecorder.Set(systemTimeColumns[i], systemScheduler.GetSystemTime(i));
+		}
+		frameStatsRecorder.EndFrame();
 	}
 
+	physicsSystem.DestroyShape(floorShape);
+	for (cpShape* houseShape : houseShapes)
+		physicsSystem.DestroyShape(houseShape);
+
 	return 0;
 }
 
@@ -258,15 +424,31 @@ void EntityInspector(const char* windowName, entt::registry& registry, entt::ent
 	ImGui::End();
 }
 
-entt::entity CreateBox(entt::registry& registry)
+entt::entity CreateBox(entt::registry& registry, PhysicsSystem& physicsSystem, const Vector2f& position)
 {
 	std::shared_ptr<Sprite> box = std::make_shared<Sprite>(ResourceManager::Instance().GetTexture("assets/box.png"));
 	box->SetOrigin({ 0.5f, 0.5f });
 
+	// La forme de collision suit les pixels opaques du sprite, relativement  son origine
+	Vector2f shapeOffset(-box->GetWidth() * box->GetOrigin().x, -box->GetHeight() * box->GetOrigin().y);
+	const CollisionGeometry& geometry = *ResourceManager::Instance().GetCollisionGeometry("assets/box.png");
+
 	entt::entity entity = registry.create();
 	registry.emplace<GraphicsComponent>(entity, std::move(box));
-	registry.emplace<Transform>(entity);
-	registry.emplace<RigidBodyComponent>(entity, 300.f);
+	registry.emplace<Transform>(entity).SetPosition(position);
+
+	RigidBodyComponent& rigidBody = registry.emplace<RigidBodyComponent>(entity, physicsSystem, 300.f);
+	rigidBody.SetPosition(cpv(position.x, position.y));
+	if (geometry.IsValid())
+	{
+		for (const PolygonShape& shape : geometry.CreateShapes(Vector2f(1.f, 1.f), shapeOffset))
+			rigidBody.AddShape(shape);
+	}
+	else
+		rigidBody.AddShape(BoxShape(256.f, 256.f));
+
+	// Ajout une fois l'entit place : l'interpolation part de sa position de dpart (voir PhysicsSystem)
+	registry.emplace<InterpolationComponent>(entity);
 
 	return entity;
 }
@@ -275,6 +457,7 @@ entt::entity CreateCamera(entt::registry& registry)
 {
 	entt::entity entity = registry.create();
 	registry.emplace<CameraComponent>(entity);
+	registry.emplace<AudioListenerComponent>(entity);
 	registry.emplace<Transform>(entity);
 
 	return entity;
@@ -291,7 +474,7 @@ entt::entity CreateHouse(entt::registry& registry)
 	return entity;
 }
 
-entt::entity CreateRunner(entt::registry& registry, std::shared_ptr<Spritesheet> spritesheet)
+entt::entity CreateRunner(entt::registry& registry, PhysicsSystem& physicsSystem, std::shared_ptr<Spritesheet> spritesheet, const Vector2f& position)
 {
 	std::shared_ptr<Sprite> sprite = std::make_shared<Sprite>(ResourceManager::Instance().GetTexture("assets/runner.png"));
 	sprite->SetOrigin({ 0.5f, 0.5f });
@@ -301,44 +484,49 @@ entt::entity CreateRunner(entt::registry& registry, std::shared_ptr<Spritesheet>
 	entt::entity entity = registry.create();
 	registry.emplace<SpritesheetComponent>(entity, spritesheet, sprite);
 	registry.emplace<GraphicsComponent>(entity, std::move(sprite));
-	registry.emplace<Transform>(entity);
+	registry.emplace<Transform>(entity).SetPosition(position);
 	registry.emplace<InputComponent>(entity);
-	registry.emplace<RigidBodyComponent>(entity, 80.f);
+
+	RigidBodyComponent& rigidBody = registry.emplace<RigidBodyComponent>(entity, physicsSystem, 80.f);
+	rigidBody.SetPosition(cpv(position.x, position.y));
+	rigidBody.AddShape(BoxShape(128.f, 256.f));
+
+	registry.emplace<InterpolationComponent>(entity);
 	registry.emplace<PlayerControlled>(entity);
 
 	return entity;
 }
 
-void HandleCameraMovement(entt::registry& registry, entt::entity camera, float deltaTime)
+void HandleCameraMovement(entt::registry& registry, entt::entity camera, const MovementActions& actions, float deltaTime)
 {
 	Transform& cameraTransform = registry.get<Transform>(camera);
 
-	if (InputManager::Instance().IsActive("CameraMoveDown"))
+	if (InputManager::Instance().IsActive(actions.down))
 		cameraTransform.Translate(Vector2f(0.f, 500.f * deltaTime));
 
-	if (InputManager::Instance().IsActive("CameraMoveLeft"))
+	if (InputManager::Instance().IsActive(actions.left))
 		cameraTransform.Translate(Vector2f(-500.f * deltaTime, 0.f));
 
-	if (InputManager::Instance().IsActive("CameraMoveRight"))
+	if (InputManager::Instance().IsActive(actions.right))
 		cameraTransform.Translate(Vector2f(500.f * deltaTime, 0.f));
 
-	if (InputManager::Instance().IsActive("CameraMoveUp"))
+	if (InputManager::Instance().IsActive(actions.up))
 		cameraTransform.Translate(Vector2f(0.f, -500.f * deltaTime));
 }
 
-void HandleRunnerMovement(entt::registry& registry, entt::entity runner, float deltaTime)
+void HandleRunnerMovement(entt::registry& registry, entt::entity runner, const MovementActions& actions, float deltaTime)
 {
 	Transform& transform = registry.get<Transform>(runner);
 
-	if (InputManager::Instance().IsActive("MoveDown"))
+	if (InputManager::Instance().IsActive(actions.down))
 		transform.Translate(Vector2f(0.f, 500.f * deltaTime));
 
-	if (InputManager::Instance().IsActive("MoveLeft"))
+	if (InputManager::Instance().IsActive(actions.left))
 		transform.Translate(Vector2f(-500.f * deltaTime, 0.f));
 
-	if (InputManager::Instance().IsActive("MoveRight"))
+	if (InputManager::Instance().IsActive(actions.right))
 		transform.Translate(Vector2f(500.f * deltaTime, 0.f));
 
-	if (InputManager::Instance().IsActive("MoveUp"))
+	if (InputManager::Instance().IsActive(actions.up))
 		transform.Translate(Vector2f(0.f, -500.f * deltaTime));
 }
\ No newline at end of file
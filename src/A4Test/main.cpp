@@ -1,10 +1,12 @@
 //#include <AL/al.h>
 //#include "AL/alc.h"
 //#include "dr_wav.h"
+#include <A4Engine/AllocationHooks.hpp>
 #include <A4Engine/SDLpp.hpp>
 #include <A4Engine/SDLppWindow.hpp>
 #include <A4Engine/SDLppRenderer.hpp>
 #include "A4Engine/Sound.hpp"
+#include "A4Engine/StreamingSound.hpp"
 #include <iostream>
 #include <A4Engine/ResourceManager.hpp>
 #include "A4Engine/SoundSystem.h"
@@ -32,11 +34,14 @@ int main()
 	SDLppWindow window("MeronEngineRendu", 1280, 720);
 	SDLppRenderer renderer(window, "", SDL_RENDERER_PRESENTVSYNC);
 
-	ResourceManager resourceManager(renderer);
+	// Sounds only hold buffers and play through the SoundSystem voices, it has to outlive them
 	SoundSystem soundSystem;
+	ResourceManager resourceManager(renderer);
 
-	std::shared_ptr<Sound> soundTest = ResourceManager::Instance().GetSound("assets/Tristram.wav");
-	soundTest->Play();
+	// Long tracks are streamed instead of being fully decoded in memory
+	StreamingSound music("assets/Tristram.wav");
+	music.SetLooping(true);
+	music.Play();
 	//std::shared_ptr<Sound> soundError = ResourceManager::Instance().GetSound("assets/Error.wav");
 	//soundError->Play();
 
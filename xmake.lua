@@ -19,9 +19,29 @@ if is_plat("windows") then
     add_cxflags("/wd4275") -- Disable warning: DLL-interface class 'class_1' used as base for DLL-interface blah
 end
 
+-- Zones de profiling (A4_PROFILE_ZONE), désactivées par défaut : xmake f --profiling=y
+option("profiling")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Compile the profiling zones of the engine")
+option_end()
+
+-- Suivi des allocations (AllocationTracker), remplace les opérateurs new/delete globaux : xmake f --allocationtracking=y
+option("allocationtracking")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Route global new/delete through the AllocationTracker")
+option_end()
+
 target("A4Engine")
     set_kind("shared")
     add_defines("A4ENGINE_BUILD")
+    if has_config("profiling") then
+        add_defines("A4ENGINE_PROFILING", { public = true })
+    end
+    if has_config("allocationtracking") then
+        add_defines("A4ENGINE_ALLOCATION_TRACKING", { public = true })
+    end
     add_headerfiles("include/A4Engine/*.h", "include/A4Engine/*.hpp", "include/A4Engine/*.inl")
     add_includedirs("include", { public = true })
     add_files("src/A4Engine/**.cpp")
@@ -40,6 +60,11 @@ target("A4Test")
     add_headerfiles("include/A4Test/*.h", "include/A4Test/*.hpp")
     add_files("src/A4Test/**.cpp")
 
+target("A4Bench")
+    set_kind("binary")
+    add_deps("A4Engine")
+    add_files("src/A4Bench/**.cpp")
+
 --
 -- If you want to known more usage about xmake, please see https://xmake.io
 --